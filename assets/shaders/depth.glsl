@@ -2,13 +2,13 @@
 #version 330 core
 
 layout (location = 0) in vec3 aPos;
+#include "include/instancing.glsl"
 
-uniform mat4 model;
 uniform mat4 lightViewProjection;
 
 void main()
 {
-    gl_Position = lightViewProjection * model * vec4(aPos, 1.0);
+    gl_Position = lightViewProjection * InstanceModel() * vec4(aPos, 1.0);
 }
 
 #shader fragment
@@ -0,0 +1,71 @@
+#shader vertex
+#version 330 core
+layout(location = 0) in vec2 aPos;
+layout(location = 1) in vec2 aTexCoord;
+
+out vec2 TexCoord;
+
+uniform vec2 uvScale; // rendered fraction of the screen texture
+
+void main()
+{
+    gl_Position = vec4(aPos, 0.0, 1.0);
+    TexCoord = aTexCoord * uvScale;
+}
+
+#shader fragment
+#version 330 core
+
+out vec4 FragColor;
+in vec2 TexCoord;
+
+uniform sampler2D screenTexture;
+uniform vec2 uvScale;
+uniform vec2 texelSize;
+
+#define FXAA_REDUCE_MIN (1.0 / 128.0)
+#define FXAA_REDUCE_MUL (1.0 / 8.0)
+#define FXAA_SPAN_MAX 8.0
+
+vec3 Sample(vec2 uv)
+{
+    // Keep taps inside the rendered region of the texture.
+    return texture(screenTexture, min(uv, uvScale - 0.5 * texelSize)).rgb;
+}
+
+float Luma(vec3 rgb)
+{
+    return dot(rgb, vec3(0.299, 0.587, 0.114));
+}
+
+void main()
+{
+    vec3 rgbM  = Sample(TexCoord);
+    float lumaNW = Luma(Sample(TexCoord + vec2(-1.0, -1.0) * texelSize));
+    float lumaNE = Luma(Sample(TexCoord + vec2( 1.0, -1.0) * texelSize));
+    float lumaSW = Luma(Sample(TexCoord + vec2(-1.0,  1.0) * texelSize));
+    float lumaSE = Luma(Sample(TexCoord + vec2( 1.0,  1.0) * texelSize));
+    float lumaM  = Luma(rgbM);
+
+    float lumaMin = min(lumaM, min(min(lumaNW, lumaNE), min(lumaSW, lumaSE)));
+    float lumaMax = max(lumaM, max(max(lumaNW, lumaNE), max(lumaSW, lumaSE)));
+
+    // Edge direction from the luma gradient.
+    vec2 dir;
+    dir.x = -((lumaNW + lumaNE) - (lumaSW + lumaSE));
+    dir.y =  ((lumaNW + lumaSW) - (lumaNE + lumaSE));
+
+    float dirReduce = max((lumaNW + lumaNE + lumaSW + lumaSE) * (0.25 * FXAA_REDUCE_MUL), FXAA_REDUCE_MIN);
+    float rcpDirMin = 1.0 / (min(abs(dir.x), abs(dir.y)) + dirReduce);
+    dir = clamp(dir * rcpDirMin, vec2(-FXAA_SPAN_MAX), vec2(FXAA_SPAN_MAX)) * texelSize;
+
+    vec3 rgbA = 0.5 * (
+        Sample(TexCoord + dir * (1.0 / 3.0 - 0.5)) +
+        Sample(TexCoord + dir * (2.0 / 3.0 - 0.5)));
+    vec3 rgbB = rgbA * 0.5 + 0.25 * (
+        Sample(TexCoord + dir * -0.5) +
+        Sample(TexCoord + dir * 0.5));
+
+    float lumaB = Luma(rgbB);
+    FragColor = vec4((lumaB < lumaMin || lumaB > lumaMax) ? rgbA : rgbB, 1.0);
+}
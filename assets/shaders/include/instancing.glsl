@@ -0,0 +1,11 @@
+// Model matrix of the current draw: per draw attribute on the multi-draw
+// indirect path, the model uniform otherwise.
+layout(location = 5) in mat4 aInstanceModel;
+
+uniform mat4 model;
+uniform int uIndirect;
+
+mat4 InstanceModel()
+{
+    return uIndirect == 1 ? aInstanceModel : model;
+}
@@ -1,13 +1,15 @@
 #shader vertex
 #version 330 core
 layout(location = 0) in vec3 aPos;
-layout(location = 1) in vec3 aNormal;
+layout(location = 1) in vec2 aNormal; // octahedral encoded
 layout(location = 2) in vec2 aTexCoord;
+#include "include/instancing.glsl"
 
 out vec2 TexCoord;
+#ifdef SHADOWS
 out vec4 FragPosLightSpace;
+#endif
 
-uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
 uniform mat4 lightViewProjection;
@@ -15,26 +17,53 @@ uniform mat4 lightViewProjection;
 out vec3 FragPos;
 out vec3 Normal;
 
+vec3 OctDecode(vec2 e)
+{
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+    return normalize(n);
+}
+
 void main() {
-    FragPos = vec3(model * vec4(aPos, 1.0));
-    Normal = mat3(transpose(inverse(model))) * aNormal;
+    mat4 m = InstanceModel();
+    FragPos = vec3(m * vec4(aPos, 1.0));
+    Normal = mat3(transpose(inverse(m))) * OctDecode(aNormal);
     TexCoord = aTexCoord;
+#ifdef SHADOWS
     FragPosLightSpace = lightViewProjection * vec4(FragPos, 1.0);
+#endif
     gl_Position = projection * view * vec4(FragPos, 1.0);
 }
 
 #shader fragment
 #version 330 core
 
+// Variant defines (injected by ShaderVariants):
+//   SHADOWS       sample the directional shadow map
+//   SPECULAR_MAP  scale specular by specular_texture1
+//   UNLIT         output albedo, skip lighting
+//   MAX_LIGHTS    size of the light array
+#ifndef MAX_LIGHTS
+#define MAX_LIGHTS 16
+#endif
+
 in vec2 TexCoord;
 in vec3 FragPos;
 in vec3 Normal;
+#ifdef SHADOWS
 in vec4 FragPosLightSpace;
+#endif
 
 out vec4 FragColor;
 
 uniform sampler2D diffuse_texture1;
+#ifdef SPECULAR_MAP
+uniform sampler2D specular_texture1;
+#endif
+#ifdef SHADOWS
 uniform sampler2D shadowMap;
+#endif
 
 struct Light {
     int type;           // 0 = Dir, 1 = Point, 2 = Spot
@@ -45,76 +74,90 @@ struct Light {
     float range;
 };
 
-uniform Light lights[16];
-uniform int lightCount;
+// Lights are uploaded sorted by type: directional, then point, then spot.
+uniform Light lights[MAX_LIGHTS];
+uniform int directionalCount;
+uniform int pointCount;
+uniform int spotCount;
 uniform vec3 viewPos;
 
-float ShadowCalculation(vec4 fragPosLightSpace, vec3 normal, vec3 lightDir);
+float ShadowCalculation(vec3 normal, vec3 lightDir);
+vec3 Shade(int i, vec3 lightDir, vec3 normal, vec3 viewDir, vec3 albedo, float specMask);
 
 void main()
 {
     vec3 albedo = texture(diffuse_texture1, TexCoord).rgb;
+
+#ifdef UNLIT
+    FragColor = vec4(albedo, 1.0);
+#else
     vec3 normal = normalize(Normal);
     vec3 viewDir = normalize(viewPos - FragPos);
 
+#ifdef SPECULAR_MAP
+    float specMask = texture(specular_texture1, TexCoord).r;
+#else
+    float specMask = 1.0;
+#endif
+
     vec3 result = 0.1 * albedo; // ambient once
 
-    for (int i = 0; i < lightCount; i++)
+    int first = 0;
+    int last = min(directionalCount, MAX_LIGHTS);
+    for (int i = first; i < last; i++)
     {
-        vec3 lightDir;
-        float attenuation = 1.0;
-        float shadow = 0.0;
-
-        if (lights[i].type == 0) // Directional
-        {
-            lightDir = normalize(-lights[i].direction);
-            shadow = ShadowCalculation(FragPosLightSpace, normal, lightDir);
-        }
-        else if (lights[i].type == 1) // Point
-        {
-            vec3 toLight = lights[i].position - FragPos;
-            float dist = length(toLight);
-            if (dist > lights[i].range) continue;
-
-            lightDir = normalize(toLight);
-            attenuation = 1.0 / (dist * dist);
-        }
-        else if (lights[i].type == 2) // Spot
-        {
-            vec3 toLight = lights[i].position - FragPos;
-            float dist = length(toLight);
-            if (dist > lights[i].range) continue;
+        vec3 lightDir = normalize(-lights[i].direction);
+        float shadow = ShadowCalculation(normal, lightDir);
+        result += (1.0 - shadow) * Shade(i, lightDir, normal, viewDir, albedo, specMask);
+    }
 
-            lightDir = normalize(toLight);
-            float theta = dot(lightDir, normalize(-lights[i].direction));
-            if (theta < 0.85) continue;
+    first = last;
+    last = min(first + pointCount, MAX_LIGHTS);
+    for (int i = first; i < last; i++)
+    {
+        vec3 toLight = lights[i].position - FragPos;
+        float dist = length(toLight);
+        if (dist > lights[i].range) continue;
 
-            attenuation = 1.0 / (dist * dist);
-            shadow = ShadowCalculation(FragPosLightSpace, normal, lightDir);
-        }
+        vec3 lightDir = toLight / dist;
+        result += Shade(i, lightDir, normal, viewDir, albedo, specMask) / (dist * dist);
+    }
 
-        float diff = max(dot(normal, lightDir), 0.0);
-        vec3 reflectDir = reflect(-lightDir, normal);
-        float spec = pow(max(dot(viewDir, reflectDir), 0.0), 32.0);
+    first = last;
+    last = min(first + spotCount, MAX_LIGHTS);
+    for (int i = first; i < last; i++)
+    {
+        vec3 toLight = lights[i].position - FragPos;
+        float dist = length(toLight);
+        if (dist > lights[i].range) continue;
 
-        vec3 diffuse  = diff * albedo * lights[i].color;
-        vec3 specular = spec * lights[i].color;
-        
-        result += (1.0 - shadow) * 
-            (diffuse + specular) * 
-            lights[i].intensity * 
-            attenuation;
+        vec3 lightDir = toLight / dist;
+        float theta = dot(lightDir, normalize(-lights[i].direction));
+        if (theta < 0.85) continue;
 
+        float shadow = ShadowCalculation(normal, lightDir);
+        result += (1.0 - shadow) * Shade(i, lightDir, normal, viewDir, albedo, specMask) / (dist * dist);
     }
 
-
     FragColor = vec4(result, 1.0);
+#endif
 }
 
+vec3 Shade(int i, vec3 lightDir, vec3 normal, vec3 viewDir, vec3 albedo, float specMask)
+{
+    float diff = max(dot(normal, lightDir), 0.0);
+    vec3 reflectDir = reflect(-lightDir, normal);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), 32.0) * specMask;
+
+    vec3 diffuse  = diff * albedo * lights[i].color;
+    vec3 specular = spec * lights[i].color;
+    return (diffuse + specular) * lights[i].intensity;
+}
 
-float ShadowCalculation(vec4 fragPosLightSpace, vec3 norm, vec3 lightDir)
+float ShadowCalculation(vec3 norm, vec3 lightDir)
 {
-    vec3 projCoords = fragPosLightSpace.xyz / fragPosLightSpace.w;
+#ifdef SHADOWS
+    vec3 projCoords = FragPosLightSpace.xyz / FragPosLightSpace.w;
     projCoords = projCoords * 0.5 + 0.5;
 
     if(projCoords.z > 1.0)
@@ -138,4 +181,7 @@ float ShadowCalculation(vec4 fragPosLightSpace, vec3 norm, vec3 lightDir)
     shadow /= pow((samples * 2 + 1), 2);
 
     return shadow;
+#else
+    return 0.0;
+#endif
 }
@@ -5,10 +5,12 @@ layout(location = 1) in vec2 aTexCoord;
 
 out vec2 TexCoord;
 
+uniform vec2 uvScale; // rendered fraction of the screen texture
+
 void main()
 {
     gl_Position = vec4(aPos, 0.0, 1.0);
-    TexCoord = aTexCoord;
+    TexCoord = aTexCoord * uvScale;
 }
 
 #shader fragment
@@ -18,6 +20,10 @@ out vec4 FragColor;
 in vec2 TexCoord;
 
 uniform sampler2D screenTexture;
+uniform vec2 uvScale;
+
 void main() {
-    FragColor = texture(screenTexture, TexCoord);
+    // Keep bilinear taps inside the rendered region of the texture.
+    vec2 uvMax = uvScale - 0.5 / vec2(textureSize(screenTexture, 0));
+    FragColor = texture(screenTexture, min(TexCoord, uvMax));
 }
\ No newline at end of file
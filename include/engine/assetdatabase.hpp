@@ -0,0 +1,74 @@
+#pragma once
+#include <engine/singleton.hpp>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Remembers source file content hashes and which inputs and settings produced
+// each cooked output, in ASSET_CACHE_DIR/assets.db. A source is only re-read
+// when its size or change stamp moved, so unchanged projects start without
+// hashing or importing anything.
+class AssetDatabase : public Singleton<AssetDatabase>
+{
+    friend class Singleton<AssetDatabase>; // REQUIRED
+
+public:
+    struct Stats
+    {
+        size_t hashed = 0;   // sources read and hashed this run
+        size_t reused = 0;   // hashes taken from the database
+        size_t upToDate = 0; // outputs whose inputs were all unchanged
+        size_t stale = 0;    // outputs that need to be produced again
+    };
+
+    // Content hash of path as seen through FileSystem; false when it cannot be read.
+    bool ContentHash(const std::string &path, uint64_t &hash);
+
+    // True when output was last recorded with these settings and none of its
+    // inputs changed since. Callers still validate the output file itself.
+    bool IsUpToDate(const std::string &output, uint64_t settings);
+
+    // Records that output was produced with settings from inputs, primary source first.
+    void RecordImport(const std::string &output, uint64_t settings, const std::vector<std::string> &inputs);
+
+    // Inputs recorded for output, empty when unknown.
+    std::vector<std::string> GetInputs(const std::string &output) const;
+
+    // Writes the database if anything changed since it was loaded or last saved.
+    void Save();
+
+    Stats GetStats() const;
+
+private:
+    struct Source
+    {
+        uint64_t size = 0;
+        int64_t stamp = 0;
+        uint64_t hash = 0;
+    };
+
+    struct Input
+    {
+        std::string path;
+        uint64_t hash = 0;
+    };
+
+    struct Import
+    {
+        uint64_t settings = 0;
+        std::vector<Input> inputs;
+    };
+
+    AssetDatabase();
+
+    bool Read(const std::string &path);
+    bool Write(const std::string &path) const;
+
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, Source> sources;
+    std::unordered_map<std::string, Import> imports;
+    bool dirty = false;
+    Stats stats;
+};
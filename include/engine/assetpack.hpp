@@ -0,0 +1,122 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <engine/mappedfile.hpp>
+
+// .opak archive: every asset of a build in one file, read through a single
+// memory mapping.
+//
+// Layout: Header, entry data (each aligned to ALIGNMENT), Entry table sorted by
+// pathHash, path strings. Stored entries can be handed to GL straight from the
+// mapping; LZ4 entries are decoded into a buffer on read.
+namespace PackFormat
+{
+    constexpr char MAGIC[4] = {'O', 'P', 'A', 'K'};
+    constexpr uint32_t VERSION = 1;
+    constexpr uint32_t ALIGNMENT = 64;
+
+    enum class Compression : uint32_t
+    {
+        None,
+        LZ4
+    };
+
+    struct Header
+    {
+        char magic[4];
+        uint32_t version;
+        uint32_t entryCount;
+        uint32_t alignment;
+        uint64_t tocOffset;
+        uint64_t stringsOffset;
+        uint64_t stringsSize;
+    };
+
+    struct Entry
+    {
+        uint64_t pathHash;
+        uint64_t contentHash; // Hash::Bytes of the uncompressed data
+        uint64_t offset;
+        uint64_t storedSize;
+        uint64_t rawSize;
+        uint32_t pathOffset;
+        uint32_t pathLength;
+        Compression compression;
+        uint32_t reserved;
+    };
+
+    // Separators unified to '/', "." and ".." folded, no leading "./".
+    std::string NormalizePath(const std::string &path);
+
+    uint64_t HashPath(const std::string &normalizedPath);
+}
+
+class AssetPack
+{
+public:
+    // nullptr when the file is missing or fails validation.
+    static std::shared_ptr<AssetPack> Open(const std::string &path);
+
+    // Looks up a normalized path; nullptr when the pack does not contain it.
+    const PackFormat::Entry *Find(const std::string &normalizedPath) const;
+
+    // Stored bytes of an entry, still compressed for LZ4 entries.
+    const uint8_t *GetStored(const PackFormat::Entry &entry) const { return data + entry.offset; }
+
+    // Decodes an entry into dst, which must hold entry.rawSize bytes.
+    bool Extract(const PackFormat::Entry &entry, uint8_t *dst) const;
+
+    std::string GetPath(const PackFormat::Entry &entry) const;
+
+    uint32_t EntryCount() const { return GetHeader().entryCount; }
+    const PackFormat::Entry &GetEntry(uint32_t index) const { return toc[index]; }
+    const std::string &GetFilePath() const { return filePath; }
+
+private:
+    const PackFormat::Header &GetHeader() const { return *reinterpret_cast<const PackFormat::Header *>(data); }
+    bool Validate();
+
+    MappedFile file;
+    std::string filePath;
+    const uint8_t *data = nullptr;
+    size_t size = 0;
+    const PackFormat::Entry *toc = nullptr;
+};
+
+// Builds a pack; used by the assetpack tool.
+class AssetPackWriter
+{
+public:
+    struct Stats
+    {
+        size_t files = 0;
+        size_t compressed = 0;
+        uint64_t rawBytes = 0;
+        uint64_t storedBytes = 0;
+    };
+
+    // LZ4 is kept only when it saves at least this share of an entry.
+    float minSavings = 0.1f;
+    bool compress = true;
+
+    // Stores sourceFile under path; the file is only read by Write().
+    void Add(const std::string &path, const std::string &sourceFile);
+
+    // Writes through a temp file; false on I/O error or duplicate paths.
+    bool Write(const std::string &path);
+
+    const Stats &GetStats() const { return stats; }
+
+private:
+    struct Pending
+    {
+        std::string path;
+        std::string sourceFile;
+    };
+
+    std::vector<Pending> pending;
+    Stats stats;
+};
@@ -9,7 +9,6 @@ public:
     EBO(const std::vector<unsigned int> &indices)
         : count(static_cast<unsigned int>(indices.size()))
     {
-        this->indices = indices;
         glGenBuffers(1, &id);
         Bind();
         glBufferData(
@@ -37,13 +36,8 @@ public:
 
     unsigned int size() const { return count; }
     unsigned int GetID() const { return id; }
-    const std::vector<uint32_t> &GetIndices() const
-    {
-        return indices;
-    }
 
 private:
     unsigned int id = 0;
     unsigned int count = 0;
-    std::vector<unsigned int> indices;
 };
@@ -7,7 +7,7 @@ class FBO
 {
 public:
     explicit FBO(int width, int height, int samples = 1, int layers = 1)
-        : m_width(width), m_height(height), m_samples(samples), m_layers(layers)
+        : m_width(width), m_height(height), m_viewWidth(width), m_viewHeight(height), m_samples(samples), m_layers(layers)
     {
         Create();
     }
@@ -35,14 +35,23 @@ public:
         if (width == m_width && height == m_height) return;
         m_width = width;
         m_height = height;
+        m_viewWidth = width;
+        m_viewHeight = height;
         Delete();
         Create();
     }
 
+    // Renders into the lower-left width x height region without reallocating.
+    void SetViewport(int width, int height)
+    {
+        m_viewWidth = width < 1 ? 1 : (width > m_width ? m_width : width);
+        m_viewHeight = height < 1 ? 1 : (height > m_height ? m_height : height);
+    }
+
     void Bind() const
     {
         glBindFramebuffer(GL_FRAMEBUFFER, m_fboID);
-        glViewport(0, 0, m_width, m_height);
+        glViewport(0, 0, m_viewWidth, m_viewHeight);
         if (m_layers > 1)
         {
             std::vector<GLenum> attachments(m_layers);
@@ -59,7 +68,7 @@ public:
         if (layer < 0 || layer >= m_layers) return;
         glBindFramebuffer(GL_FRAMEBUFFER, m_fboID);
         glDrawBuffer(GL_COLOR_ATTACHMENT0 + layer);
-        glViewport(0, 0, m_width, m_height);
+        glViewport(0, 0, m_viewWidth, m_viewHeight);
     }
 
     static void Unbind(int w, int h)
@@ -75,6 +84,11 @@ public:
         return m_colorTex[layer];
     }
 
+    int GetWidth() const { return m_width; }
+    int GetHeight() const { return m_height; }
+    int GetViewportWidth() const { return m_viewWidth; }
+    int GetViewportHeight() const { return m_viewHeight; }
+
     bool IsMSAA() const { return m_samples > 1; }
 
     void BlitTo(const FBO& target) const
@@ -83,8 +97,8 @@ public:
         glBindFramebuffer(GL_READ_FRAMEBUFFER, m_fboID);
         glBindFramebuffer(GL_DRAW_FRAMEBUFFER, target.GetID());
         glBlitFramebuffer(
-            0, 0, m_width, m_height,
-            0, 0, target.m_width, target.m_height,
+            0, 0, m_viewWidth, m_viewHeight,
+            0, 0, m_viewWidth, m_viewHeight,
             GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT,
             GL_NEAREST
         );
@@ -98,6 +112,8 @@ private:
 
     int m_width = 0;
     int m_height = 0;
+    int m_viewWidth = 0;
+    int m_viewHeight = 0;
     int m_samples = 1;
     int m_layers = 1;
 
@@ -167,6 +183,8 @@ private:
         m_rbo = other.m_rbo;
         m_width = other.m_width;
         m_height = other.m_height;
+        m_viewWidth = other.m_viewWidth;
+        m_viewHeight = other.m_viewHeight;
         m_samples = other.m_samples;
         m_layers = other.m_layers;
 
@@ -0,0 +1,477 @@
+#pragma once
+#include <map>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <algorithm>
+#include <stdexcept>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <engine/singleton.hpp>
+#include <engine/buffers/vbo.hpp>
+
+// Layout of one glMultiDrawElementsIndirect record.
+struct DrawElementsIndirectCommand
+{
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint baseVertex;
+    GLuint baseInstance;
+};
+
+// First-fit free list over [0, capacity) in element units, coalescing on free.
+class RangeAllocator
+{
+public:
+    bool Allocate(uint32_t size, uint32_t &offset)
+    {
+        for (auto it = freeBlocks.begin(); it != freeBlocks.end(); ++it)
+        {
+            if (it->second < size)
+                continue;
+
+            offset = it->first;
+            uint32_t remaining = it->second - size;
+            freeBlocks.erase(it);
+            if (remaining)
+                freeBlocks[offset + size] = remaining;
+            freeSpace -= size;
+            return true;
+        }
+        return false;
+    }
+
+    void Free(uint32_t offset, uint32_t size)
+    {
+        if (!size)
+            return;
+
+        auto next = freeBlocks.lower_bound(offset);
+        if (next != freeBlocks.begin())
+        {
+            auto prev = std::prev(next);
+            if (prev->first + prev->second == offset)
+            {
+                offset = prev->first;
+                size += prev->second;
+                freeBlocks.erase(prev);
+            }
+        }
+        if (next != freeBlocks.end() && offset + size == next->first)
+        {
+            size += next->second;
+            freeBlocks.erase(next);
+        }
+
+        freeBlocks[offset] = size;
+        freeSpace += size;
+    }
+
+    void Grow(uint32_t newCapacity)
+    {
+        if (newCapacity <= capacity)
+            return;
+        uint32_t added = newCapacity - capacity;
+        uint32_t start = capacity;
+        capacity = newCapacity;
+        Free(start, added);
+    }
+
+    // After compaction everything below used is live and the rest is one block.
+    void Reset(uint32_t newCapacity, uint32_t used)
+    {
+        freeBlocks.clear();
+        capacity = newCapacity;
+        freeSpace = 0;
+        Free(used, newCapacity - used);
+    }
+
+    uint32_t Capacity() const { return capacity; }
+    uint32_t FreeSpace() const { return freeSpace; }
+    uint32_t Used() const { return capacity - freeSpace; }
+    size_t FreeBlockCount() const { return freeBlocks.size(); }
+
+    uint32_t LargestFreeBlock() const
+    {
+        uint32_t largest = 0;
+        for (auto &block : freeBlocks)
+            largest = std::max(largest, block.second);
+        return largest;
+    }
+
+private:
+    std::map<uint32_t, uint32_t> freeBlocks; // offset -> size
+    uint32_t capacity = 0;
+    uint32_t freeSpace = 0;
+};
+
+class GeometryPool;
+
+// A mesh's slice of a GeometryPool. Offsets are updated in place when the pool
+// grows or defragments; the ranges are returned to the pool on destruction.
+struct GeometryAllocation
+{
+    std::shared_ptr<GeometryPool> pool;
+    uint32_t baseVertex = 0;
+    uint32_t vertexCount = 0;
+    uint32_t firstIndex = 0;
+    uint32_t indexCount = 0;
+
+    ~GeometryAllocation();
+};
+
+// Suballocates every mesh of one vertex layout out of shared vertex/index
+// buffers, so all of them draw from a single VAO with base-vertex offsets.
+class GeometryPool : public std::enable_shared_from_this<GeometryPool>
+{
+public:
+    GeometryPool(VertexLayout layout, GLenum indexType, GLuint instanceBuffer)
+        : layout(layout), indexType(indexType), instanceBuffer(instanceBuffer)
+    {
+        glGenVertexArrays(1, &vao);
+        Reallocate(INITIAL_VERTICES, INITIAL_INDICES, false);
+    }
+
+    ~GeometryPool()
+    {
+        DeleteBuffers(vbo, skinVbo, ebo);
+        if (vao)
+            glDeleteVertexArrays(1, &vao);
+    }
+
+    GeometryPool(const GeometryPool &) = delete;
+    GeometryPool &operator=(const GeometryPool &) = delete;
+
+    std::unique_ptr<GeometryAllocation> Allocate(
+        const PackedVertex *vertices,
+        const SkinVertex *skin,
+        uint32_t vertexCount,
+        const uint32_t *indices,
+        uint32_t indexCount)
+    {
+        uint32_t vertexOffset = 0, indexOffset = 0;
+        while (!vertexRanges.Allocate(vertexCount, vertexOffset))
+            Reallocate(GrowSize(vertexRanges.Capacity(), vertexCount), indexRanges.Capacity(), false);
+        while (!indexRanges.Allocate(indexCount, indexOffset))
+            Reallocate(vertexRanges.Capacity(), GrowSize(indexRanges.Capacity(), indexCount), false);
+
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glBufferSubData(GL_ARRAY_BUFFER, (GLintptr)vertexOffset * sizeof(PackedVertex), (GLsizeiptr)vertexCount * sizeof(PackedVertex), vertices);
+
+        if (skinVbo)
+        {
+            glBindBuffer(GL_ARRAY_BUFFER, skinVbo);
+            if (skin)
+                glBufferSubData(GL_ARRAY_BUFFER, (GLintptr)vertexOffset * sizeof(SkinVertex), (GLsizeiptr)vertexCount * sizeof(SkinVertex), skin);
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        // 16 bit pools only receive meshes whose indices fit, see GeometryAllocator.
+        std::vector<uint16_t> narrow;
+        const void *indexData = indices;
+        if (indexType == GL_UNSIGNED_SHORT)
+        {
+            narrow.assign(indices, indices + indexCount);
+            indexData = narrow.data();
+        }
+
+        // Element array binding is VAO state, upload through the copy target instead.
+        glBindBuffer(GL_COPY_WRITE_BUFFER, ebo);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)indexOffset * IndexSize(), (GLsizeiptr)indexCount * IndexSize(), indexData);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+        auto allocation = std::make_unique<GeometryAllocation>();
+        allocation->pool = shared_from_this();
+        allocation->baseVertex = vertexOffset;
+        allocation->vertexCount = vertexCount;
+        allocation->firstIndex = indexOffset;
+        allocation->indexCount = indexCount;
+        live.push_back(allocation.get());
+        return allocation;
+    }
+
+    // Grows the buffers once so the next allocations totalling these counts fit
+    // without a reallocation and copy per mesh.
+    void Reserve(uint32_t vertexCount, uint32_t indexCount)
+    {
+        uint32_t vertexCapacity = vertexRanges.Capacity();
+        uint32_t indexCapacity = indexRanges.Capacity();
+        if (vertexRanges.LargestFreeBlock() < vertexCount)
+            vertexCapacity = GrowSize(vertexCapacity, vertexCount);
+        if (indexRanges.LargestFreeBlock() < indexCount)
+            indexCapacity = GrowSize(indexCapacity, indexCount);
+
+        if (vertexCapacity != vertexRanges.Capacity() || indexCapacity != indexRanges.Capacity())
+            Reallocate(vertexCapacity, indexCapacity, false);
+    }
+
+    void Free(GeometryAllocation *allocation)
+    {
+        auto it = std::find(live.begin(), live.end(), allocation);
+        if (it == live.end())
+            return;
+        live.erase(it);
+
+        vertexRanges.Free(allocation->baseVertex, allocation->vertexCount);
+        indexRanges.Free(allocation->firstIndex, allocation->indexCount);
+    }
+
+    // Share of free space not usable by one contiguous allocation, in [0, 1].
+    float GetFragmentation() const
+    {
+        auto frag = [](const RangeAllocator &r)
+        {
+            return r.FreeSpace() ? 1.0f - (float)r.LargestFreeBlock() / (float)r.FreeSpace() : 0.0f;
+        };
+        return std::max(frag(vertexRanges), frag(indexRanges));
+    }
+
+    // Packs every live allocation to the front of fresh buffers.
+    void Defragment()
+    {
+        Reallocate(vertexRanges.Capacity(), indexRanges.Capacity(), true);
+    }
+
+    void Bind() const { glBindVertexArray(vao); }
+    static void Unbind() { glBindVertexArray(0); }
+
+    VertexLayout GetLayout() const { return layout; }
+    GLenum GetIndexType() const { return indexType; }
+    size_t IndexSize() const { return indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(uint32_t); }
+    size_t GetAllocationCount() const { return live.size(); }
+    const RangeAllocator &GetVertexRanges() const { return vertexRanges; }
+    const RangeAllocator &GetIndexRanges() const { return indexRanges; }
+
+private:
+    static constexpr uint32_t INITIAL_VERTICES = 1 << 16;
+    static constexpr uint32_t INITIAL_INDICES = 1 << 18;
+
+    static uint32_t GrowSize(uint32_t capacity, uint32_t request)
+    {
+        uint32_t size = std::max(capacity, 1u);
+        while (size < capacity + request)
+            size *= 2;
+        return size;
+    }
+
+    void Reallocate(uint32_t vertexCapacity, uint32_t indexCapacity, bool compact)
+    {
+        GLuint newVbo = 0, newSkin = 0, newEbo = 0;
+        newVbo = CreateBuffer((GLsizeiptr)vertexCapacity * sizeof(PackedVertex));
+        if (layout == VertexLayout::Skinned)
+            newSkin = CreateBuffer((GLsizeiptr)vertexCapacity * sizeof(SkinVertex));
+        newEbo = CreateBuffer((GLsizeiptr)indexCapacity * IndexSize());
+
+        if (vbo && compact)
+        {
+            std::vector<GeometryAllocation *> order = live;
+
+            std::sort(order.begin(), order.end(), [](auto *a, auto *b)
+                      { return a->baseVertex < b->baseVertex; });
+            uint32_t vertexCursor = 0;
+            for (auto *a : order)
+            {
+                CopyRange(vbo, newVbo, a->baseVertex, vertexCursor, a->vertexCount, sizeof(PackedVertex));
+                if (skinVbo)
+                    CopyRange(skinVbo, newSkin, a->baseVertex, vertexCursor, a->vertexCount, sizeof(SkinVertex));
+                a->baseVertex = vertexCursor;
+                vertexCursor += a->vertexCount;
+            }
+
+            std::sort(order.begin(), order.end(), [](auto *a, auto *b)
+                      { return a->firstIndex < b->firstIndex; });
+            uint32_t indexCursor = 0;
+            for (auto *a : order)
+            {
+                // Indices are relative to baseVertex, so they move unchanged.
+                CopyRange(ebo, newEbo, a->firstIndex, indexCursor, a->indexCount, IndexSize());
+                a->firstIndex = indexCursor;
+                indexCursor += a->indexCount;
+            }
+
+            vertexRanges.Reset(vertexCapacity, vertexCursor);
+            indexRanges.Reset(indexCapacity, indexCursor);
+        }
+        else
+        {
+            if (vbo)
+            {
+                CopyRange(vbo, newVbo, 0, 0, vertexRanges.Capacity(), sizeof(PackedVertex));
+                if (skinVbo)
+                    CopyRange(skinVbo, newSkin, 0, 0, vertexRanges.Capacity(), sizeof(SkinVertex));
+                CopyRange(ebo, newEbo, 0, 0, indexRanges.Capacity(), IndexSize());
+            }
+            vertexRanges.Grow(vertexCapacity);
+            indexRanges.Grow(indexCapacity);
+        }
+
+        DeleteBuffers(vbo, skinVbo, ebo);
+        vbo = newVbo;
+        skinVbo = newSkin;
+        ebo = newEbo;
+
+        SetupVertexArray();
+    }
+
+    void SetupVertexArray()
+    {
+        glBindVertexArray(vao);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(PackedVertex), (void *)(offsetof(PackedVertex, position)));
+        glEnableVertexAttribArray(0);
+
+        // Octahedral normal, decoded in the shader
+        glVertexAttribPointer(1, 2, GL_SHORT, GL_TRUE, sizeof(PackedVertex), (void *)(offsetof(PackedVertex, normal)));
+        glEnableVertexAttribArray(1);
+
+        glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(PackedVertex), (void *)(offsetof(PackedVertex, uv)));
+        glEnableVertexAttribArray(2);
+
+        if (skinVbo)
+        {
+            glBindBuffer(GL_ARRAY_BUFFER, skinVbo);
+            glVertexAttribIPointer(3, 4, GL_UNSIGNED_BYTE, sizeof(SkinVertex), (void *)(offsetof(SkinVertex, boneIDs)));
+            glEnableVertexAttribArray(3);
+
+            glVertexAttribPointer(4, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(SkinVertex), (void *)(offsetof(SkinVertex, weights)));
+            glEnableVertexAttribArray(4);
+        }
+
+        // Per-draw model matrix for multi-draw indirect, indexed by baseInstance
+        glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+        for (int i = 0; i < 4; ++i)
+        {
+            glVertexAttribPointer(5 + i, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void *)(sizeof(glm::vec4) * i));
+            glEnableVertexAttribArray(5 + i);
+            glVertexAttribDivisor(5 + i, 1);
+        }
+
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    static GLuint CreateBuffer(GLsizeiptr size)
+    {
+        GLuint id = 0;
+        glGenBuffers(1, &id);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, id);
+        glBufferData(GL_COPY_WRITE_BUFFER, size, nullptr, GL_STATIC_DRAW);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        return id;
+    }
+
+    static void CopyRange(GLuint src, GLuint dst, uint32_t from, uint32_t to, uint32_t count, size_t stride)
+    {
+        if (!count)
+            return;
+        glBindBuffer(GL_COPY_READ_BUFFER, src);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, dst);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, (GLintptr)(from * stride), (GLintptr)(to * stride), (GLsizeiptr)(count * stride));
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+
+    static void DeleteBuffers(GLuint &a, GLuint &b, GLuint &c)
+    {
+        GLuint ids[3] = {a, b, c};
+        for (GLuint id : ids)
+            if (id)
+                glDeleteBuffers(1, &id);
+        a = b = c = 0;
+    }
+
+    VertexLayout layout;
+    GLenum indexType;
+    GLuint vao = 0;
+    GLuint vbo = 0;
+    GLuint skinVbo = 0;
+    GLuint ebo = 0;
+    GLuint instanceBuffer = 0;
+
+    RangeAllocator vertexRanges;
+    RangeAllocator indexRanges;
+    std::vector<GeometryAllocation *> live;
+};
+
+inline GeometryAllocation::~GeometryAllocation()
+{
+    if (pool)
+        pool->Free(this);
+}
+
+// Owns one GeometryPool per vertex layout and the shared per-draw instance buffer.
+class GeometryAllocator : public Singleton<GeometryAllocator>
+{
+    friend class Singleton<GeometryAllocator>; // REQUIRED
+
+public:
+    // Pools above this fragmentation are compacted by Maintain().
+    float defragmentThreshold = 0.5f;
+
+    // Mesh indices are relative to baseVertex, so 16 bits cover up to 65536 vertices.
+    static bool NeedsWideIndices(uint32_t vertexCount)
+    {
+        return vertexCount > 65536;
+    }
+
+    GeometryPool &GetPool(VertexLayout layout, bool wideIndices)
+    {
+        auto &pool = pools[(size_t)layout][wideIndices ? 1 : 0];
+        if (!pool)
+            pool = std::make_shared<GeometryPool>(layout, wideIndices ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT, GetInstanceBuffer());
+        return *pool;
+    }
+
+    // skin is only read for VertexLayout::Skinned and may be null otherwise.
+    // Meshes small enough for 16 bit indices go to the layout's 16 bit pool.
+    std::unique_ptr<GeometryAllocation> Allocate(
+        VertexLayout layout,
+        const PackedVertex *vertices,
+        const SkinVertex *skin,
+        uint32_t vertexCount,
+        const uint32_t *indices,
+        uint32_t indexCount)
+    {
+        return GetPool(layout, NeedsWideIndices(vertexCount)).Allocate(vertices, skin, vertexCount, indices, indexCount);
+    }
+
+    void Reserve(VertexLayout layout, bool wideIndices, uint32_t vertexCount, uint32_t indexCount)
+    {
+        GetPool(layout, wideIndices).Reserve(vertexCount, indexCount);
+    }
+
+    GLuint GetInstanceBuffer()
+    {
+        if (!instanceBuffer)
+        {
+            glGenBuffers(1, &instanceBuffer);
+            glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+            glBufferData(GL_ARRAY_BUFFER, sizeof(glm::mat4), nullptr, GL_STREAM_DRAW);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+        }
+        return instanceBuffer;
+    }
+
+    // Called once per frame, outside of draw submission.
+    void Maintain()
+    {
+        for (auto &byLayout : pools)
+            for (auto &pool : byLayout)
+                if (pool && pool->GetFragmentation() > defragmentThreshold)
+                    pool->Defragment();
+    }
+
+private:
+    GeometryAllocator() = default;
+    ~GeometryAllocator()
+    {
+        if (instanceBuffer)
+            glDeleteBuffers(1, &instanceBuffer);
+    }
+
+    std::shared_ptr<GeometryPool> pools[2][2]; // [layout][wide indices]
+    GLuint instanceBuffer = 0;
+};
@@ -1,8 +1,15 @@
 #pragma once
 #include <vector>
+#include <string>
+#include <cstdint>
+#include <cmath>
+#include <unordered_map>
 #include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
 #define MAX_BONE_INFLUENCE 4
 
+// Full precision vertex produced by the importer, packed before upload.
 struct Vertex
 {
     glm::vec3 position;
@@ -13,18 +20,95 @@ struct Vertex
     float weights[MAX_BONE_INFLUENCE]{0.0f};
 };
 
-struct Skeleton
+enum class VertexLayout
 {
-    std::unordered_map<std::string, int> boneMap;
-    std::vector<BoneInfo> bones;
+    Static, // PackedVertex stream only
+    Skinned // PackedVertex stream + SkinVertex stream
+};
+
+// GPU vertex stream used by every layout (20 bytes):
+// float position, octahedral snorm16 normal, half float uv.
+struct PackedVertex
+{
+    glm::vec3 position;
+    int16_t normal[2];
+    uint16_t uv[2];
+};
+
+// Second stream for skinned meshes (8 bytes): uint8 bone indices, unorm8 weights.
+struct SkinVertex
+{
+    uint8_t boneIDs[MAX_BONE_INFLUENCE];
+    uint8_t weights[MAX_BONE_INFLUENCE];
 };
 
+inline glm::vec2 OctEncode(glm::vec3 n)
+{
+    float sum = std::fabs(n.x) + std::fabs(n.y) + std::fabs(n.z);
+    if (sum <= 0.0f)
+        return glm::vec2(0.0f); // decodes to +Z
+
+    n /= sum;
+    glm::vec2 p(n.x, n.y);
+    if (n.z < 0.0f)
+    {
+        p = glm::vec2(
+            (1.0f - std::fabs(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f),
+            (1.0f - std::fabs(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f));
+    }
+    return p;
+}
+
+inline PackedVertex PackVertex(const Vertex &v)
+{
+    PackedVertex out;
+    out.position = v.position;
+
+    glm::vec2 oct = OctEncode(v.normal);
+    out.normal[0] = (int16_t)std::lround(glm::clamp(oct.x, -1.0f, 1.0f) * 32767.0f);
+    out.normal[1] = (int16_t)std::lround(glm::clamp(oct.y, -1.0f, 1.0f) * 32767.0f);
+
+    out.uv[0] = glm::packHalf1x16(v.uv.x);
+    out.uv[1] = glm::packHalf1x16(v.uv.y);
+    return out;
+}
+
+inline SkinVertex PackSkin(const Vertex &v)
+{
+    SkinVertex out{};
+
+    float total = 0.0f;
+    for (int i = 0; i < MAX_BONE_INFLUENCE; ++i)
+        total += v.weights[i];
+    if (total <= 0.0f)
+        return out;
+
+    // Quantize so the weights still sum to exactly 255.
+    int sum = 0, heaviest = 0;
+    for (int i = 0; i < MAX_BONE_INFLUENCE; ++i)
+    {
+        out.boneIDs[i] = (uint8_t)glm::clamp(v.boneIDs[i], 0, 255);
+        out.weights[i] = (uint8_t)std::lround(v.weights[i] / total * 255.0f);
+        sum += out.weights[i];
+        if (v.weights[i] > v.weights[heaviest])
+            heaviest = i;
+    }
+    out.weights[heaviest] = (uint8_t)glm::clamp(out.weights[heaviest] + 255 - sum, 0, 255);
+    return out;
+}
+
 struct BoneInfo
 {
     glm::mat4 offset; // inverse bind pose
     glm::mat4 finalTransform;
 };
 
+struct Skeleton
+{
+    std::unordered_map<std::string, int> boneMap;
+    std::vector<BoneInfo> bones;
+};
+
 template <typename T>
 class VBO
 {
@@ -32,7 +116,6 @@ public:
     VBO(const std::vector<T> &data)
         : count(static_cast<unsigned int>(data.size()))
     {
-        this->vertices = data;
         glGenBuffers(1, &id);
         Bind();
         glBufferData(
@@ -60,21 +143,8 @@ public:
 
     unsigned int Size() const { return count; }
     unsigned int GetID() const { return id; }
-    std::vector<glm::vec3> GetPoints() const
-    {
-        std::vector<glm::vec3> points;
-        points.reserve(vertices.size());
-
-        for (const auto &v : vertices)
-        {
-            points.push_back(v.position);
-        }
-
-        return points;
-    }
 
 private:
     unsigned int id = 0;
     unsigned int count = 0;
-    std::vector<T> vertices;
 };
@@ -6,6 +6,8 @@
 
 class Camera : public Component
 {
+    friend class SceneSerializer;
+
 public:
     Camera(int w, int h)
     {
@@ -5,6 +5,8 @@
 
 class Looker : public Component
 {
+    friend class SceneSerializer;
+
 public:
     Looker(float sensitivity = 0.1f, float speed = 5.0f);
 
@@ -1,73 +1,97 @@
 #pragma once
 #include <memory>
+#include <functional>
 #include <engine/shader.hpp>
 
-#include <engine/buffers/vao.hpp>
 #include <engine/buffers/vbo.hpp>
-#include <engine/buffers/ebo.hpp>
+#include <engine/buffers/geometry.hpp>
 
-#include <engine/texture2D.hpp>
+#include <engine/texturecache.hpp>
+#include <engine/render/bounds.hpp>
+#include <engine/render/meshlet.hpp>
+
+// Whether a mesh keeps CPU-side geometry after upload.
+enum class MeshResidency
+{
+    GpuOnly, // CPU data is dropped once uploaded
+    KeepCpu  // positions/indices stay resident for physics, occlusion or picking
+};
+
+// Immutable CPU copy of a mesh's triangles, shared by every consumer that needs it.
+struct MeshGeometry
+{
+    std::vector<glm::vec3> positions;
+    std::vector<uint32_t> indices;
+};
 
 class Mesh
 {
 public:
-    Mesh(const std::vector<Vertex> &vertices, const std::vector<unsigned int> &indices, const std::vector<std::shared_ptr<Texture2D>> &textures)
+    Mesh(const std::vector<Vertex> &vertices, const std::vector<unsigned int> &indices, const std::vector<std::shared_ptr<Texture2D>> &textures, VertexLayout layout = VertexLayout::Static, MeshResidency residency = MeshResidency::GpuOnly)
+        : layout(layout)
     {
-        for (auto &t : textures)
-        {
-            this->textures.push_back(std::move(t));
-        }
-        vao = std::make_unique<VAO>();
-        vbo = std::make_unique<VBO<Vertex>>(vertices);
-        ebo = std::make_unique<EBO>(indices);
-
-        vao->Bind();
-        ebo->Bind();
-        vbo->Bind();
-
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)0);
-        glEnableVertexAttribArray(0);
-
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)(offsetof(Vertex, normal)));
-        glEnableVertexAttribArray(1);
+        AABB box;
+        for (auto &v : vertices)
+            box.Expand(v.position);
 
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)(offsetof(Vertex, uv)));
-        glEnableVertexAttribArray(2);
+        std::vector<PackedVertex> packed;
+        packed.reserve(vertices.size());
+        for (auto &v : vertices)
+            packed.push_back(PackVertex(v));
 
-        vao->Unbind();
-
-        if (this->textures.empty())
+        std::vector<SkinVertex> skin;
+        if (layout == VertexLayout::Skinned)
         {
-            this->textures.push_back(LoadDefaultTexture());
+            skin.reserve(vertices.size());
+            for (auto &v : vertices)
+                skin.push_back(PackSkin(v));
         }
-    }
 
-    std::vector<glm::vec3> GetPoints()
-    {
-        return vbo->GetPoints();
+        Init(packed.data(), skin.empty() ? nullptr : skin.data(), (uint32_t)packed.size(), indices.data(), (uint32_t)indices.size(), textures, box, residency);
     }
 
-    std::vector<uint32_t> GetIndices()
+    // Builds straight from streams already in GPU layout, e.g. a mapped model cache file.
+    Mesh(const PackedVertex *vertices, const SkinVertex *skin, uint32_t vertexCount, const uint32_t *indices, uint32_t indexCount, const std::vector<std::shared_ptr<Texture2D>> &textures, const AABB &bounds, VertexLayout layout = VertexLayout::Static, MeshResidency residency = MeshResidency::GpuOnly)
+        : layout(layout)
     {
-        return ebo->GetIndices();
+        Init(vertices, skin, vertexCount, indices, indexCount, textures, bounds, residency);
     }
 
-    void DrawDepth()
+    // Null unless the mesh was created with MeshResidency::KeepCpu.
+    std::shared_ptr<const MeshGeometry> GetGeometry() const { return geometry; }
+
+    const AABB &GetBounds() const { return bounds; }
+    uint32_t GetIndexCount() const { return allocation->indexCount; }
+
+    // Empty unless the mesh is dense enough to cull per meshlet.
+    const std::vector<Meshlet> &GetMeshlets() const { return meshlets; }
+    void SetMeshlets(std::vector<Meshlet> list) { meshlets = std::move(list); }
+    VertexLayout GetLayout() const { return layout; }
+
+    const GeometryAllocation &GetAllocation() const { return *allocation; }
+    GeometryPool &GetPool() const { return *allocation->pool; }
+    size_t GetMaterialKey() const { return materialKey; }
+    bool SharesMaterial(const Mesh &other) const { return textures == other.textures; }
+
+    bool HasTexture(Type type) const
     {
-        vao->Bind();
-        glDrawElements(GL_TRIANGLES, ebo->size(), GL_UNSIGNED_INT, 0);
-        vao->Unbind();
+        for (auto &t : textures)
+            if (t->type == type)
+                return true;
+        return false;
     }
 
-    void Draw(const Shader &shader)
-    {
-        shader.Use();
+    // Unit 1 holds the shadow map; material textures start after it.
+    static constexpr unsigned int MATERIAL_TEXTURE_UNIT = 2;
 
+    void BindMaterial(const Shader &shader) const
+    {
         unsigned int diffuseNr = 1;
         unsigned int specularNr = 1;
         for (unsigned int i = 0; i < textures.size(); i++)
         {
-            textures[i]->Bind(i);
+            unsigned int unit = MATERIAL_TEXTURE_UNIT + i;
+            textures[i]->Bind(unit);
             std::string number;
             std::string name;
             if (textures[i]->type == Type::DIFFUSE)
@@ -81,22 +105,66 @@ public:
                 number = std::to_string(specularNr++);
             }
 
-            shader.SetUniform(name + number, (int)i);
+            if (!name.empty())
+                shader.SetUniform(name + number, (int)unit);
         }
+    }
+
+    // Draws this mesh's range of the currently bound pool.
+    void DrawElements() const
+    {
+        DrawElements(0, allocation->indexCount);
+    }
 
-        // draw buffer
-        vao->Bind();
-        glDrawElements(GL_TRIANGLES, ebo->size(), GL_UNSIGNED_INT, 0);
-        vao->Unbind();
+    // Draws part of the mesh, firstIndex relative to its own index range.
+    void DrawElements(uint32_t firstIndex, uint32_t indexCount) const
+    {
+        const GeometryPool &pool = GetPool();
+        glDrawElementsBaseVertex(
+            GL_TRIANGLES,
+            (GLsizei)indexCount,
+            pool.GetIndexType(),
+            (void *)(pool.IndexSize() * (allocation->firstIndex + firstIndex)),
+            (GLint)allocation->baseVertex);
     }
 
 private:
-    std::unique_ptr<VAO> vao = nullptr;
-    std::unique_ptr<VBO<Vertex>> vbo = nullptr;
-    std::unique_ptr<EBO> ebo = nullptr;
+    void Init(const PackedVertex *vertices, const SkinVertex *skin, uint32_t vertexCount, const uint32_t *indices, uint32_t indexCount, const std::vector<std::shared_ptr<Texture2D>> &textures, const AABB &box, MeshResidency residency)
+    {
+        bounds = box;
+        this->textures = textures;
+
+        allocation = GeometryAllocator::Get().Allocate(layout, vertices, layout == VertexLayout::Skinned ? skin : nullptr, vertexCount, indices, indexCount);
+
+        if (this->textures.empty())
+        {
+            this->textures.push_back(LoadDefaultTexture());
+        }
+
+        // Meshes sharing textures can be drawn in one batch
+        for (auto &t : this->textures)
+            materialKey = materialKey * 31 + std::hash<const Texture2D *>()(t.get());
+
+        if (residency == MeshResidency::KeepCpu)
+        {
+            auto cpu = std::make_shared<MeshGeometry>();
+            cpu->positions.reserve(vertexCount);
+            for (uint32_t i = 0; i < vertexCount; ++i)
+                cpu->positions.push_back(vertices[i].position);
+            cpu->indices.assign(indices, indices + indexCount);
+            geometry = std::move(cpu);
+        }
+    }
+
+    std::unique_ptr<GeometryAllocation> allocation;
+    size_t materialKey = 0;
     std::vector<std::shared_ptr<Texture2D>> textures;
+    std::shared_ptr<const MeshGeometry> geometry;
+    std::vector<Meshlet> meshlets;
+    AABB bounds;
+    VertexLayout layout = VertexLayout::Static;
     std::shared_ptr<Texture2D> LoadDefaultTexture()
     {
-        return std::make_shared<Texture2D>("assets/textures/default_sprite.png");
+        return TextureCache::Get().Load("assets/textures/default_sprite.png");
     }
 };
\ No newline at end of file
@@ -5,16 +5,10 @@
 class MeshRenderer : public Component
 {
 public:
+    // Pick the cheaper scene shader variants for this object.
+    bool lit = true;
+    bool castShadows = true;
+    bool receiveShadows = true;
+
     MeshRenderer() {}
-    void Render(const Shader &shader)
-    {
-        auto en = entity.lock();
-        auto render = en->GetComponent<MeshFilter>();
-        if (render)
-        {
-            shader.Use();
-            shader.SetUniform("model", en->WorldMatrix());
-            en->GetComponent<MeshFilter>()->mesh->Draw(shader);
-        }
-    }
 };
\ No newline at end of file
@@ -0,0 +1,38 @@
+#pragma once
+#include <engine/ecs/entity.hpp>
+#include <engine/components/meshfilter.hpp>
+
+// Marks every mesh in this entity's subtree as an occluder for the CPU occlusion pass.
+class Occluder : public Component
+{
+public:
+    struct Shape
+    {
+        std::weak_ptr<Entity> owner;
+        std::shared_ptr<const MeshGeometry> geometry;
+    };
+
+    std::vector<Shape> shapes;
+
+public:
+    void OnAttach() override
+    {
+        shapes.clear();
+        if (auto en = entity.lock())
+            Gather(en);
+    }
+
+private:
+    void Gather(const std::shared_ptr<Entity> &node)
+    {
+        if (auto meshfilter = node->GetComponent<MeshFilter>())
+        {
+            // Only meshes loaded with MeshResidency::KeepCpu have triangles to rasterize
+            if (meshfilter->mesh && meshfilter->mesh->GetGeometry())
+                shapes.push_back({node, meshfilter->mesh->GetGeometry()});
+        }
+
+        for (auto &child : node->GetChildren())
+            Gather(child);
+    }
+};
@@ -1,8 +1,8 @@
 #pragma once
+#include <engine/ecs/entity.hpp>
 #include <engine/ecs/physics.component.hpp>
 #include <Bullet3/btBulletDynamicsCommon.h>
 #include <glm/glm.hpp>
-#include <engine/systems/physics.hpp>
 
 enum class CollisionType
 {
@@ -17,4 +17,7 @@ class Collider : public Component
 public:
     CollisionType type = CollisionType::BOX;
     virtual btCollisionShape *CreateShape() const { return nullptr; }
+
+    // Queues the entity with PhysicsSystem, which builds its body before the next step.
+    void OnAttach() override;
 };
@@ -2,49 +2,63 @@
 #include <engine/components/physics/collider/collider.hpp>
 #include <engine/components/meshfilter.hpp>
 
+// Bullet mesh interface reading straight from a shared MeshGeometry, keeping it alive.
+class SharedTriangleMesh : public btTriangleIndexVertexArray
+{
+public:
+    explicit SharedTriangleMesh(std::shared_ptr<const MeshGeometry> geometry)
+        : geometry(std::move(geometry))
+    {
+        btIndexedMesh mesh;
+        mesh.m_numTriangles = (int)(this->geometry->indices.size() / 3);
+        mesh.m_triangleIndexBase = reinterpret_cast<const unsigned char *>(this->geometry->indices.data());
+        mesh.m_triangleIndexStride = 3 * sizeof(uint32_t);
+        mesh.m_numVertices = (int)this->geometry->positions.size();
+        mesh.m_vertexBase = reinterpret_cast<const unsigned char *>(this->geometry->positions.data());
+        mesh.m_vertexStride = sizeof(glm::vec3);
+        mesh.m_indexType = PHY_INTEGER;
+        mesh.m_vertexType = PHY_FLOAT;
+        addIndexedMesh(mesh, PHY_INTEGER);
+    }
+
+private:
+    std::shared_ptr<const MeshGeometry> geometry;
+};
+
 class MeshCollider3D : public Collider
 {
 public:
-    std::vector<glm::vec3> vertices;
-    std::vector<uint32_t> indices;
+    std::shared_ptr<const MeshGeometry> geometry;
 
 public:
-    MeshCollider3D() { type = CollisionType::CAPSULE; }
+    MeshCollider3D() { type = CollisionType::MESH; }
 
     void OnAttach() override
     {
         auto en = entity.lock();
-        if (en)
+        if (!en)
             return;
-        // setup indeces, vertices
-        if (auto meshfilter = en->GetComponent<MeshFilter>())
+        // share the mesh's resident geometry
+        auto meshfilter = en->GetComponent<MeshFilter>();
+        if (meshfilter && meshfilter->mesh)
         {
-            auto mesh = meshfilter->mesh;
-            vertices = mesh->GetPoints();
-            indices = mesh->GetIndices();
+            geometry = meshfilter->mesh->GetGeometry();
+            if (!geometry)
+                throw std::runtime_error("MeshCollider3D requires a mesh loaded with MeshResidency::KeepCpu!.");
         }
         else
         {
             throw std::runtime_error("Mesh is null Collider require meshfilter!.");
         }
+        Collider::OnAttach();
     }
 
+    // The shape doesn't own its mesh interface; PhysicsSystem frees it with the shape.
     btCollisionShape *CreateShape() const override
     {
-        btTriangleMesh *triangleMesh = new btTriangleMesh();
-
-        for (size_t i = 0; i < indices.size(); i += 3)
-        {
-            const glm::vec3 &v0 = vertices[indices[i]];
-            const glm::vec3 &v1 = vertices[indices[i + 1]];
-            const glm::vec3 &v2 = vertices[indices[i + 2]];
-
-            triangleMesh->addTriangle(
-                btVector3(v0.x, v0.y, v0.z),
-                btVector3(v1.x, v1.y, v1.z),
-                btVector3(v2.x, v2.y, v2.z));
-        }
+        if (!geometry || geometry->indices.size() < 3)
+            return nullptr;
 
-        return new btBvhTriangleMeshShape(triangleMesh, true);
+        return new btBvhTriangleMeshShape(new SharedTriangleMesh(geometry), true);
     }
 };
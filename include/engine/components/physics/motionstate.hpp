@@ -0,0 +1,108 @@
+#pragma once
+#include <engine/ecs/entity.hpp>
+#include <Bullet3/btBulletDynamicsCommon.h>
+
+// Motion state bound to an entity's Transform. PhysicsSystem records the body's
+// previous and current step in Step. Bullet's synchronizeMotionStates only calls
+// setWorldTransform for active bodies, which queues the state in moved;
+// PhysicsSystem drains that once per frame into the entities, blending the two
+// steps when interpolating. Sleeping and static bodies cost nothing.
+class EntityMotionState : public btMotionState
+{
+public:
+    BT_DECLARE_ALIGNED_ALLOCATOR();
+
+    EntityMotionState(const std::shared_ptr<Entity> &entity, std::vector<EntityMotionState *> &moved, bool interpolate)
+        : entity(entity), previous(FromEntity(*entity)), current(previous), moved(moved), interpolate(interpolate) {}
+
+    void getWorldTransform(btTransform &worldTrans) const override
+    {
+        worldTrans = current;
+    }
+
+    // Bullet's own interpolated transform is ignored, the steps are blended in Apply
+    void setWorldTransform(const btTransform &) override
+    {
+        if (!queued)
+        {
+            queued = true;
+            moved.push_back(this);
+        }
+    }
+
+    // Called after every fixed step with the body's new transform.
+    void Step(const btTransform &worldTrans)
+    {
+        previous = current;
+        current = worldTrans;
+    }
+
+    // Writes the entity, alpha of the way from the previous step to the current one.
+    void Apply(float alpha)
+    {
+        queued = false;
+        auto en = entity.lock();
+        if (!en)
+            return;
+
+        if (!interpolate)
+        {
+            Apply(*en, current);
+            return;
+        }
+
+        btTransform blended;
+        blended.setOrigin(previous.getOrigin().lerp(current.getOrigin(), alpha));
+        blended.setRotation(previous.getRotation().slerp(current.getRotation(), alpha));
+        Apply(*en, blended);
+    }
+
+    // World space position and rotation of entity; scale is left to the shape.
+    static btTransform FromEntity(const Entity &entity)
+    {
+        glm::mat4 model = entity.WorldMatrix();
+        glm::quat rotation = Rotation(model);
+
+        btTransform result;
+        result.setOrigin(btVector3(model[3].x, model[3].y, model[3].z));
+        result.setRotation(btQuaternion(rotation.x, rotation.y, rotation.z, rotation.w));
+        return result;
+    }
+
+    // Writes a world transform to entity, relative to its parent for children.
+    static void Apply(Entity &entity, const btTransform &worldTrans)
+    {
+        const btVector3 &pos = worldTrans.getOrigin();
+        const btQuaternion rot = worldTrans.getRotation();
+
+        glm::vec3 position(pos.x(), pos.y(), pos.z());
+        glm::quat rotation(rot.w(), rot.x(), rot.y(), rot.z());
+
+        if (auto parent = entity.GetParent())
+        {
+            glm::mat4 local = glm::inverse(parent->WorldMatrix()) *
+                              glm::translate(glm::mat4(1.0f), position) * glm::toMat4(rotation);
+            position = glm::vec3(local[3]);
+            rotation = Rotation(local);
+        }
+
+        entity.transform.position = position;
+        entity.transform.rotation = rotation;
+    }
+
+private:
+    static glm::quat Rotation(const glm::mat4 &model)
+    {
+        return glm::quat_cast(glm::mat3(
+            glm::normalize(glm::vec3(model[0])),
+            glm::normalize(glm::vec3(model[1])),
+            glm::normalize(glm::vec3(model[2]))));
+    }
+
+    std::weak_ptr<Entity> entity;
+    btTransform previous;
+    btTransform current;
+    std::vector<EntityMotionState *> &moved;
+    bool interpolate = true;
+    bool queued = false;
+};
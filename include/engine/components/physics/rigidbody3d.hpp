@@ -1,7 +1,7 @@
 #pragma once
 #include <engine/ecs/component.hpp>
+#include <engine/ecs/entity.hpp>
 #include <engine/ecs/physics.component.hpp>
-#include <engine/systems/physics.hpp>
 #include <glm/glm.hpp>
 
 enum class ForceMode
@@ -12,6 +12,12 @@ enum class ForceMode
     VelocityChange // Instant velocity change
 };
 
+enum class RigidbodyInterpolation
+{
+    None,       // Snap to the latest physics step
+    Interpolate // Blend the last two steps, one step behind
+};
+
 class RigidBody3D : public Component
 {
 public:
@@ -31,9 +37,15 @@ public:
     bool freezeRotationY = false;
     bool freezeRotationZ = false;
 
+    // Read when the body is built; keeps motion smooth when frames don't line up with steps
+    RigidbodyInterpolation interpolation = RigidbodyInterpolation::Interpolate;
+
 public:
     RigidBody3D(float m = 1.0f) : mass(m) {}
 
+    // Queues the entity so an existing static body is rebuilt with this mass.
+    void OnAttach() override;
+
     /* =========================
        Unity-like Methods
        ========================= */
@@ -1,7 +1,7 @@
 #pragma once
 #include <glad/glad.h>
 #include <engine/ecs/entity.hpp>
-#include <engine/shader.hpp>
+#include <engine/shadercache.hpp>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <engine/components/ui/element.hpp>
@@ -12,7 +12,7 @@ public:
     Canvas(int w, int h)
         : width(w), height(h)
     {
-        shader = std::make_shared<Shader>("assets/shaders/uielement.glsl");
+        shader = ShaderCache::Get().Load("assets/shaders/uielement.glsl");
 
         view = glm::mat4(1.0f);
         projection = glm::ortho(
@@ -1,7 +1,7 @@
 #pragma once
 #include <engine/components/ui/element.hpp>
 #include <engine/buffers/vao.hpp>
-#include <engine/texture2D.hpp>
+#include <engine/texturecache.hpp>
 #include <memory>
 
 class Image : public UIElement
@@ -9,10 +9,12 @@ class Image : public UIElement
 public:
     Image(const std::string& path)
     {
-        texture = std::make_shared<Texture2D>(path, Type::DIFFUSE, false);
+        texture = TextureCache::Get().Load(path, Type::DIFFUSE, false);
         vao = CreateQuad();
     }
 
+    const std::string &GetPath() const { return texture->path; }
+
     void Render() override
     {
         texture->Bind(0);
@@ -1,4 +1,7 @@
 #pragma once
 #define SCREEN_WIDTH 956
 #define SCREEN_HEIGHT 540
-#define APPLICATION_TITLE "olia - engine"
\ No newline at end of file
+#define APPLICATION_TITLE "olia - engine"
+#define ASSET_CACHE_DIR "cache"
+#define ASSET_PACK_FILE "assets.opak"
+#define STARTUP_TRACE_FILE ASSET_CACHE_DIR "/startup_trace.json"
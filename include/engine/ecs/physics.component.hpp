@@ -2,9 +2,36 @@
 #include <engine/ecs/component.hpp>
 #include <Bullet3/btBulletDynamicsCommon.h>
 
+// Added by PhysicsSystem to entities with a collider; owns the Bullet body.
 class PhysicsComponent : public Component
 {
 public:
     btRigidBody* body = nullptr;
     btCollisionShape* shape = nullptr;
+    btDynamicsWorld* world = nullptr; // the world body lives in
+
+public:
+    ~PhysicsComponent() override { Release(); }
+
+    // Takes the body out of its world and frees it with its motion state and shape.
+    void Release()
+    {
+        if (body)
+        {
+            if (world)
+                world->removeRigidBody(body);
+            delete body->getMotionState();
+            delete body;
+        }
+        if (shape)
+        {
+            // Triangle mesh shapes don't own their mesh interface
+            if (shape->getShapeType() == TRIANGLE_MESH_SHAPE_PROXYTYPE)
+                delete static_cast<btBvhTriangleMeshShape*>(shape)->getMeshInterface();
+            delete shape;
+        }
+        body = nullptr;
+        shape = nullptr;
+        world = nullptr;
+    }
 };
@@ -5,13 +5,20 @@
 #include "scene.hpp"
 #include "window/platform.hpp"
 #include "input.hpp"
+#include "filesystem.hpp"
+#include "configure.hpp"
 #include "model.hpp"
+#include "sceneloader.hpp"
+#include "scenefile.hpp"
+#include "tracer.hpp"
+#include "assetdatabase.hpp"
 #include "systems/physics.hpp"
 
 // Components
 #include "components/camera.hpp"
 #include "components/looker.hpp"
 #include "components/light.hpp"
+#include "components/occluder.hpp"
 #include "components/physics/rigidbody3d.hpp"
 #include "components/physics/collider/boxcollider3d.hpp"
 #include "components/physics/collider/spherecollider3d.hpp"
@@ -28,12 +35,24 @@ namespace Engine
         Engine() = default;
         ~Engine() = default;
 
-        // Initialize the engine with screen size and title
-        void Initialize(int width, int height, const char* title);
+        // Initialize the engine with screen size and title. scenePath, when given,
+        // is an .oscn file loaded instead of the built-in default scene.
+        void Initialize(int width, int height, const char* title, bool headless = false, const char* scenePath = nullptr);
 
         // Run the main loop
         void Run();
 
+        // Run without presenting until the initial loads finish, then for frameCount
+        // frames (0 = unlimited) or until timeBudget seconds pass (0 = unlimited),
+        // and print frame timings for both phases.
+        void RunHeadless(uint32_t frameCount, float timeBudget = 0.0f);
+
+        // Writes the active scene to an .oscn file.
+        bool SaveScene(const std::string& path);
+
+        // Builds a scene of entityCount entities, saves and reloads it, then prints timings.
+        void BenchmarkSceneIO(uint32_t entityCount);
+
         // Shutdown engine and cleanup resources
         void Shutdown();
 
@@ -45,7 +64,15 @@ namespace Engine
         int screenWidth = 800;
         int screenHeight = 600;
         const char* appTitle = "Engine App";
+        bool startupPending = true;
 
         void SetupDefaultScene();
+
+        // One iteration of the main loop, shared by Run and RunHeadless.
+        void Frame();
+
+        // Once the initial loads have settled: ends the startup trace and saves
+        // the asset database.
+        void FinishStartup();
     };
 } // namespace Engine
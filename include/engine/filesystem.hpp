@@ -0,0 +1,157 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <engine/singleton.hpp>
+#include <engine/assetpack.hpp>
+#include <engine/mappedfile.hpp>
+
+// Contents of one file. Points into a pack or file mapping when the bytes are
+// stored as-is, and owns a decoded copy otherwise. Empty when the file is missing.
+class FileView
+{
+    friend class FileSystem;
+
+public:
+    bool IsOpen() const { return data != nullptr; }
+    const uint8_t *Data() const { return data; }
+    size_t Size() const { return size; }
+
+    std::string ToString() const
+    {
+        return std::string(reinterpret_cast<const char *>(data), size);
+    }
+
+private:
+    const uint8_t *data = nullptr;
+    size_t size = 0;
+    std::shared_ptr<const void> owner; // keeps the mapping or decoded buffer alive
+};
+
+// Single entry point for reading assets. Mounted packs are searched newest first,
+// then the loose file on disk. Mount during startup only: lookups from loader
+// threads are not synchronized against it.
+class FileSystem : public Singleton<FileSystem>
+{
+    friend class Singleton<FileSystem>; // REQUIRED
+
+public:
+    bool Mount(const std::string &packPath)
+    {
+        auto pack = AssetPack::Open(packPath);
+        if (!pack)
+            return false;
+
+        std::cout << "[FileSystem] Mounted " << packPath << " (" << pack->EntryCount() << " files)" << std::endl;
+        packs.push_back(std::move(pack));
+        return true;
+    }
+
+    void UnmountAll()
+    {
+        packs.clear();
+    }
+
+    FileView Open(const std::string &path) const
+    {
+        FileView view;
+
+        const PackFormat::Entry *entry = nullptr;
+        if (auto pack = FindInPacks(path, entry))
+        {
+            if (entry->compression == PackFormat::Compression::None)
+            {
+                view.data = pack->GetStored(*entry);
+                view.size = (size_t)entry->rawSize;
+                view.owner = pack;
+                return view;
+            }
+
+            auto buffer = std::make_shared<std::vector<uint8_t>>((size_t)entry->rawSize);
+            if (!pack->Extract(*entry, buffer->data()))
+            {
+                std::cout << "[FileSystem] Corrupt pack entry: " << path << std::endl;
+                return view;
+            }
+            view.data = buffer->data();
+            view.size = buffer->size();
+            view.owner = buffer;
+            return view;
+        }
+
+        auto file = std::make_shared<MappedFile>(path);
+        if (file->IsOpen())
+        {
+            view.data = file->Data();
+            view.size = file->Size();
+            view.owner = file;
+        }
+        return view;
+    }
+
+    bool Exists(const std::string &path) const
+    {
+        const PackFormat::Entry *entry = nullptr;
+        if (FindInPacks(path, entry))
+            return true;
+
+        std::error_code ec;
+        return std::filesystem::is_regular_file(path, ec);
+    }
+
+    // Size and a change stamp (content hash in packs, write time on disk), for
+    // deciding whether derived cache entries are stale without reading the file.
+    bool Stat(const std::string &path, uint64_t &size, int64_t &stamp) const
+    {
+        const PackFormat::Entry *entry = nullptr;
+        if (FindInPacks(path, entry))
+        {
+            size = entry->rawSize;
+            stamp = (int64_t)entry->contentHash;
+            return true;
+        }
+
+        std::error_code ec;
+        size = (uint64_t)std::filesystem::file_size(path, ec);
+        if (ec)
+            return false;
+        stamp = (int64_t)std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+        return !ec;
+    }
+
+    // Sibling of path to write before renaming over it. Unique per call, so
+    // threads or engine instances producing the same cache file never share a temp file.
+    static std::string TempPath(const std::string &path)
+    {
+        static const uint32_t instance = std::random_device{}();
+        static std::atomic<uint64_t> counter{0};
+        size_t thread = std::hash<std::thread::id>{}(std::this_thread::get_id());
+        return path + "." + std::to_string(instance) + "-" + std::to_string(thread & 0xffff) + "-" +
+               std::to_string(counter++) + ".tmp";
+    }
+
+private:
+    FileSystem() = default;
+
+    std::shared_ptr<const AssetPack> FindInPacks(const std::string &path, const PackFormat::Entry *&entry) const
+    {
+        if (packs.empty())
+            return nullptr;
+
+        std::string normalized = PackFormat::NormalizePath(path);
+        for (auto it = packs.rbegin(); it != packs.rend(); ++it)
+            if ((entry = (*it)->Find(normalized)))
+                return *it;
+        return nullptr;
+    }
+
+    std::vector<std::shared_ptr<const AssetPack>> packs;
+};
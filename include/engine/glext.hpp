@@ -0,0 +1,101 @@
+#pragma once
+#include <glad/glad.h>
+#include <cstring>
+
+// Entry points beyond the GL 3.3 core that glad was generated for.
+// Loaded once after the context is created; null when the driver lacks them.
+
+#ifndef GL_DRAW_INDIRECT_BUFFER
+#define GL_DRAW_INDIRECT_BUFFER 0x8F3F
+#endif
+
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+#ifndef GL_COMPRESSED_SRGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_SRGB_S3TC_DXT1_EXT 0x8C4C
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT 0x8C4F
+#endif
+
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+typedef void(APIENTRYP PFNGLGETPROGRAMBINARYPROC)(GLuint program, GLsizei bufSize, GLsizei *length, GLenum *binaryFormat, void *binary);
+typedef void(APIENTRYP PFNGLPROGRAMBINARYPROC)(GLuint program, GLenum binaryFormat, const void *binary, GLsizei length);
+typedef void(APIENTRYP PFNGLPROGRAMPARAMETERIPROC)(GLuint program, GLenum pname, GLint value);
+typedef void(APIENTRYP PFNGLMULTIDRAWELEMENTSINDIRECTPROC)(GLenum mode, GLenum type, const void *indirect, GLsizei drawcount, GLsizei stride);
+
+namespace GLExt
+{
+    inline int majorVersion = 3;
+    inline int minorVersion = 3;
+
+    inline PFNGLMULTIDRAWELEMENTSINDIRECTPROC MultiDrawElementsIndirect = nullptr;
+
+    // Program binaries (4.1 / ARB_get_program_binary)
+    inline PFNGLGETPROGRAMBINARYPROC GetProgramBinary = nullptr;
+    inline PFNGLPROGRAMBINARYPROC ProgramBinary = nullptr;
+    inline PFNGLPROGRAMPARAMETERIPROC ProgramParameteri = nullptr;
+
+    // BC1/BC3 (S3TC) upload; BC4 (RGTC) is core in 3.x.
+    inline bool textureCompressionS3TC = false;
+    inline bool textureCompressionS3TCsRGB = false;
+
+    inline bool IsVersion(int major, int minor)
+    {
+        return majorVersion > major || (majorVersion == major && minorVersion >= minor);
+    }
+
+    inline bool HasExtension(const char *name)
+    {
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        for (GLint i = 0; i < count; ++i)
+        {
+            const char *ext = reinterpret_cast<const char *>(glGetStringi(GL_EXTENSIONS, (GLuint)i));
+            if (ext && std::strcmp(ext, name) == 0)
+                return true;
+        }
+        return false;
+    }
+
+    inline void Load(GLADloadproc load)
+    {
+        glGetIntegerv(GL_MAJOR_VERSION, &majorVersion);
+        glGetIntegerv(GL_MINOR_VERSION, &minorVersion);
+
+        if (IsVersion(4, 3) || HasExtension("GL_ARB_multi_draw_indirect"))
+            MultiDrawElementsIndirect = (PFNGLMULTIDRAWELEMENTSINDIRECTPROC)load("glMultiDrawElementsIndirect");
+
+        if (IsVersion(4, 1) || HasExtension("GL_ARB_get_program_binary"))
+        {
+            GetProgramBinary = (PFNGLGETPROGRAMBINARYPROC)load("glGetProgramBinary");
+            ProgramBinary = (PFNGLPROGRAMBINARYPROC)load("glProgramBinary");
+            ProgramParameteri = (PFNGLPROGRAMPARAMETERIPROC)load("glProgramParameteri");
+        }
+
+        textureCompressionS3TC = HasExtension("GL_EXT_texture_compression_s3tc");
+        textureCompressionS3TCsRGB = textureCompressionS3TC && HasExtension("GL_EXT_texture_sRGB");
+    }
+
+    // Drivers may expose the entry points but report no binary formats.
+    inline bool SupportsProgramBinary()
+    {
+        if (!GetProgramBinary || !ProgramBinary || !ProgramParameteri)
+            return false;
+        GLint formats = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        return formats > 0;
+    }
+
+    // Needs baseInstance to offset instanced attributes, core since 4.2.
+    inline bool SupportsMultiDrawIndirect()
+    {
+        return MultiDrawElementsIndirect != nullptr && IsVersion(4, 2);
+    }
+}
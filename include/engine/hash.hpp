@@ -0,0 +1,50 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+// Non-cryptographic 64 bit hashes for cache keys and change detection.
+namespace Hash
+{
+    constexpr uint64_t FNV_OFFSET = 1469598103934665603ull;
+    constexpr uint64_t FNV_PRIME = 1099511628211ull;
+
+    inline uint64_t Fnv1a(const void *data, size_t size, uint64_t hash = FNV_OFFSET)
+    {
+        const unsigned char *bytes = static_cast<const unsigned char *>(data);
+        for (size_t i = 0; i < size; ++i)
+        {
+            hash ^= bytes[i];
+            hash *= FNV_PRIME;
+        }
+        return hash;
+    }
+
+    inline uint64_t Fnv1a(const std::string &text, uint64_t hash = FNV_OFFSET)
+    {
+        return Fnv1a(text.data(), text.size(), hash);
+    }
+
+    // Word at a time, for hashing whole files quickly.
+    inline uint64_t Bytes(const void *data, size_t size, uint64_t hash = FNV_OFFSET)
+    {
+        const unsigned char *bytes = static_cast<const unsigned char *>(data);
+        size_t words = size / 8;
+        for (size_t i = 0; i < words; ++i)
+        {
+            uint64_t word;
+            std::memcpy(&word, bytes + i * 8, 8);
+            hash = (hash ^ word) * FNV_PRIME;
+            hash ^= hash >> 29;
+        }
+        hash = Fnv1a(bytes + words * 8, size - words * 8, hash);
+
+        // Finalizer so the length and last bytes reach every output bit.
+        hash ^= (uint64_t)size;
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdull;
+        hash ^= hash >> 33;
+        return hash;
+    }
+}
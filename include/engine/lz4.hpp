@@ -0,0 +1,21 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// LZ4 block format (no frame header), compatible with the reference decoder.
+// Fast enough to decompress at load time that packed entries cost less than
+// reading their uncompressed bytes from disk.
+namespace LZ4
+{
+    // Worst case output size for size input bytes.
+    inline size_t CompressBound(size_t size)
+    {
+        return size + size / 255 + 16;
+    }
+
+    // Returns the compressed size, or 0 when the output does not fit in capacity.
+    size_t Compress(const uint8_t *src, size_t size, uint8_t *dst, size_t capacity);
+
+    // Decodes exactly rawSize bytes; false on malformed or truncated input.
+    bool Decompress(const uint8_t *src, size_t size, uint8_t *dst, size_t rawSize);
+}
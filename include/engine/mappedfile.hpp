@@ -0,0 +1,45 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Read-only memory mapping of a whole file. IsOpen() is false when the file is
+// missing or empty; nothing throws. The platform code lives in mappedfile.cpp so
+// this header, included almost everywhere, never pulls in <windows.h> (and its
+// near/far macros).
+class MappedFile
+{
+public:
+    MappedFile() = default;
+
+    explicit MappedFile(const std::string &path)
+    {
+        Open(path);
+    }
+
+    ~MappedFile()
+    {
+        Close();
+    }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    bool Open(const std::string &path);
+    void Close();
+
+    bool IsOpen() const { return data != nullptr; }
+    const uint8_t *Data() const { return data; }
+    size_t Size() const { return size; }
+
+private:
+    const uint8_t *data = nullptr;
+    size_t size = 0;
+
+#ifdef _WIN32
+    void *file = nullptr;    // HANDLE, null when closed
+    void *mapping = nullptr; // HANDLE
+#else
+    int fd = -1;
+#endif
+};
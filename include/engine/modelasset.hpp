@@ -0,0 +1,316 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include <filesystem>
+#include <unordered_map>
+#include <cstdint>
+
+#include <engine/singleton.hpp>
+#include <engine/ecs/entity.hpp>
+#include <engine/components/mesh.hpp>
+#include <engine/components/meshfilter.hpp>
+#include <engine/components/meshrenderer.hpp>
+#include <engine/texturecache.hpp>
+#include <engine/buffers/geometry.hpp>
+#include <engine/modelimporter.hpp>
+#include <engine/scene.hpp>
+
+// Immutable result of loading a model once: GPU meshes with their materials and
+// the node hierarchy used as a template for every instance.
+class ModelAsset
+{
+public:
+    struct Node
+    {
+        std::string name;
+        int32_t parent; // index into nodes, -1 for children of the instance root
+        Transform transform;
+        std::vector<uint32_t> meshes;
+    };
+
+    // Tag for the staged constructor.
+    struct Staged
+    {
+    };
+
+    ModelAsset(std::shared_ptr<const ModelFile> file, const std::string &directory, MeshResidency residency)
+        : ModelAsset(std::move(file), directory, residency, Staged{})
+    {
+        UploadMeshes(SIZE_MAX);
+    }
+
+    // Queues the textures and builds the node template only; meshes are created
+    // by UploadMeshes() so their GL upload can be spread over several frames.
+    ModelAsset(std::shared_ptr<const ModelFile> modelFile, const std::string &directory, MeshResidency residency, Staged)
+        : source(std::move(modelFile)), residency(residency)
+    {
+        const ModelFile &file = *source;
+
+        // Queue every texture decode before touching GL so the workers overlap
+        // with the geometry upload.
+        pendingTextures.resize(file.MeshCount());
+        uint32_t vertexTotals[2][2] = {}, indexTotals[2][2] = {}; // [layout][wide indices]
+        for (uint32_t i = 0; i < file.MeshCount(); i++)
+        {
+            const ModelFormat::Mesh &record = file.GetMesh(i);
+            pendingTextures[i] = LoadTextures(file, record, directory);
+
+            bool wide = GeometryAllocator::NeedsWideIndices(record.vertexCount);
+            vertexTotals[record.layout][wide] += record.vertexCount;
+            indexTotals[record.layout][wide] += record.indexCount;
+        }
+
+        // One pool growth per pool instead of one per mesh
+        for (size_t layout = 0; layout < 2; layout++)
+            for (size_t wide = 0; wide < 2; wide++)
+                if (vertexTotals[layout][wide])
+                    GeometryAllocator::Get().Reserve((VertexLayout)layout, wide == 1, vertexTotals[layout][wide], indexTotals[layout][wide]);
+
+        meshes.reserve(file.MeshCount());
+
+        nodes.reserve(file.NodeCount());
+        for (uint32_t i = 0; i < file.NodeCount(); i++)
+        {
+            const ModelFormat::Node &record = file.GetNode(i);
+
+            Node node;
+            node.name = file.GetString(record.nameOffset, record.nameLength);
+            node.parent = record.parent;
+            node.transform.position = {record.position[0], record.position[1], record.position[2]};
+            node.transform.rotation = glm::quat(record.rotation[0], record.rotation[1], record.rotation[2], record.rotation[3]);
+            node.transform.scale = {record.scale[0], record.scale[1], record.scale[2]};
+            for (uint32_t m = 0; m < record.meshRefCount; m++)
+                node.meshes.push_back(file.GetMeshRef(record.firstMeshRef + m));
+            nodes.push_back(std::move(node));
+        }
+    }
+
+    // Creates pending meshes until about budget bytes of geometry went to GL, at
+    // least one per call. Returns the bytes uploaded; see IsComplete().
+    size_t UploadMeshes(size_t budget)
+    {
+        if (!source)
+            return 0;
+
+        TRACE_SCOPE("Mesh upload");
+        size_t spent = 0;
+        while (meshes.size() < source->MeshCount() && (spent == 0 || spent < budget))
+        {
+            size_t i = meshes.size();
+            const ModelFormat::Mesh &record = source->GetMesh((uint32_t)i);
+            meshes.push_back(CreateMesh(*source, record, std::move(pendingTextures[i])));
+            spent += GeometryBytes(record);
+        }
+
+        // Meshes hold their own copies, the source image is no longer needed.
+        if (meshes.size() == source->MeshCount())
+        {
+            source.reset();
+            pendingTextures.clear();
+        }
+        return spent;
+    }
+
+    bool IsComplete() const { return !source; }
+
+    float GetUploadProgress() const
+    {
+        if (!source || source->MeshCount() == 0)
+            return 1.0f;
+        return (float)meshes.size() / (float)source->MeshCount();
+    }
+
+    // Builds a new entity hierarchy whose MeshFilters share this asset's meshes.
+    std::shared_ptr<Entity> Instantiate(const std::shared_ptr<Scene> &scene) const
+    {
+        auto root = std::make_shared<Entity>("ModelRoot");
+        root->scene = scene;
+
+        // Nodes are stored parents first
+        std::vector<std::shared_ptr<Entity>> entities(nodes.size());
+        for (size_t i = 0; i < nodes.size(); i++)
+        {
+            const Node &node = nodes[i];
+
+            auto entity = std::make_shared<Entity>(node.name);
+            entity->scene = scene;
+            entity->transform = node.transform;
+
+            (node.parent < 0 ? root : entities[node.parent])->AddChild(entity);
+
+            for (uint32_t mesh : node.meshes)
+            {
+                entity->AddComponent<MeshFilter>(meshes[mesh]);
+                entity->AddComponent<MeshRenderer>();
+            }
+
+            entities[i] = entity;
+        }
+
+        return root;
+    }
+
+    const std::vector<std::shared_ptr<Mesh>> &GetMeshes() const { return meshes; }
+    const std::vector<Node> &GetNodes() const { return nodes; }
+    MeshResidency GetResidency() const { return residency; }
+
+private:
+    static std::vector<std::shared_ptr<Texture2D>> LoadTextures(
+        const ModelFile &file,
+        const ModelFormat::Mesh &record,
+        const std::string &directory)
+    {
+        std::vector<std::shared_ptr<Texture2D>> textures;
+        for (uint32_t t = 0; t < record.textureCount; t++)
+        {
+            const ModelFormat::TextureRef &ref = file.GetTexture(record.firstTexture + t);
+            textures.push_back(
+                TextureCache::Get().LoadAsync(
+                    directory + "/" + file.GetString(ref.pathOffset, ref.pathLength),
+                    (Type)ref.type));
+        }
+        return textures;
+    }
+
+    static size_t GeometryBytes(const ModelFormat::Mesh &record)
+    {
+        size_t vertexSize = sizeof(PackedVertex);
+        if (record.layout == (uint32_t)VertexLayout::Skinned)
+            vertexSize += sizeof(SkinVertex);
+        size_t indexSize = GeometryAllocator::NeedsWideIndices(record.vertexCount) ? sizeof(uint32_t) : sizeof(uint16_t);
+        return (size_t)record.vertexCount * vertexSize + (size_t)record.indexCount * indexSize;
+    }
+
+    std::shared_ptr<Mesh> CreateMesh(
+        const ModelFile &file,
+        const ModelFormat::Mesh &record,
+        std::vector<std::shared_ptr<Texture2D>> textures) const
+    {
+        AABB bounds;
+        bounds.min = {record.boundsMin[0], record.boundsMin[1], record.boundsMin[2]};
+        bounds.max = {record.boundsMax[0], record.boundsMax[1], record.boundsMax[2]};
+
+        // Vertex and index data go straight from the mapped file to the geometry pool
+        auto mesh = std::make_shared<Mesh>(
+            file.GetVertices(record),
+            file.GetSkin(record),
+            record.vertexCount,
+            file.GetIndices(record),
+            record.indexCount,
+            textures,
+            bounds,
+            (VertexLayout)record.layout,
+            residency);
+
+        const Meshlet *meshlets = file.GetMeshlets(record);
+        mesh->SetMeshlets(std::vector<Meshlet>(meshlets, meshlets + record.meshletCount));
+        return mesh;
+    }
+
+    std::shared_ptr<const ModelFile> source; // until every mesh is created
+    std::vector<std::vector<std::shared_ptr<Texture2D>>> pendingTextures;
+
+    std::vector<std::shared_ptr<Mesh>> meshes;
+    std::vector<Node> nodes;
+    MeshResidency residency;
+};
+
+// Keeps every loaded ModelAsset so later loads of the same file only instantiate
+// entities. Assets stay resident until Unload() or Clear().
+class ModelRegistry : public Singleton<ModelRegistry>
+{
+    friend class Singleton<ModelRegistry>; // REQUIRED
+
+public:
+    struct Stats
+    {
+        size_t hits = 0;
+        size_t loads = 0;
+    };
+
+    std::shared_ptr<const ModelAsset> Load(const std::string &path, MeshResidency residency = MeshResidency::GpuOnly)
+    {
+        if (auto asset = Find(path, residency))
+            return asset;
+
+        TRACE_SCOPE("Model::Load", path);
+        auto asset = std::make_shared<const ModelAsset>(ModelImporter::LoadCached(path), Directory(path), residency);
+        Insert(path, asset);
+        return asset;
+    }
+
+    // Returns the loaded asset able to serve this residency, or null. A KeepCpu
+    // asset also serves GpuOnly requests; the reverse needs a reload.
+    std::shared_ptr<const ModelAsset> Find(const std::string &path, MeshResidency residency)
+    {
+        auto it = assets.find(Canonical(path));
+        if (it == assets.end() ||
+            (residency == MeshResidency::KeepCpu && it->second.asset->GetResidency() != MeshResidency::KeepCpu))
+            return nullptr;
+
+        stats.hits++;
+        return it->second.asset;
+    }
+
+    // Registers an asset built elsewhere, e.g. by a background load.
+    void Insert(const std::string &path, std::shared_ptr<const ModelAsset> asset)
+    {
+        assets[Canonical(path)] = {path, std::move(asset)};
+        stats.loads++;
+    }
+
+    bool IsLoaded(const std::string &path) const
+    {
+        return assets.count(Canonical(path)) != 0;
+    }
+
+    // Instances keep their meshes alive; this only drops the registry's reference.
+    void Unload(const std::string &path)
+    {
+        assets.erase(Canonical(path));
+    }
+
+    void Clear()
+    {
+        assets.clear();
+    }
+
+    const Stats &GetStats() const { return stats; }
+
+    // Calls fn(path, asset) for every loaded asset, path as first requested.
+    template <typename Fn>
+    void ForEach(Fn fn) const
+    {
+        for (auto &[key, entry] : assets)
+            fn(entry.path, *entry.asset);
+    }
+
+    // Directory material texture paths are relative to.
+    static std::string Directory(const std::string &path)
+    {
+        size_t slash = path.find_last_of("/\\");
+        return slash == std::string::npos ? "." : path.substr(0, slash);
+    }
+
+private:
+    ModelRegistry() = default;
+
+    static std::string Canonical(const std::string &path)
+    {
+        std::error_code ec;
+        std::filesystem::path p = std::filesystem::weakly_canonical(path, ec);
+        if (ec)
+            p = std::filesystem::path(path).lexically_normal();
+        return p.generic_string();
+    }
+
+    struct Entry
+    {
+        std::string path;
+        std::shared_ptr<const ModelAsset> asset;
+    };
+
+    std::unordered_map<std::string, Entry> assets;
+    Stats stats;
+};
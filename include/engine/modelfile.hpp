@@ -0,0 +1,368 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <engine/buffers/vbo.hpp>
+#include <engine/render/bounds.hpp>
+#include <engine/render/meshlet.hpp>
+#include <engine/texture2D.hpp>
+#include <engine/mappedfile.hpp>
+#include <engine/filesystem.hpp>
+
+// Processed model in final GPU layout, as produced by the importer.
+struct ModelMeshData
+{
+    VertexLayout layout = VertexLayout::Static;
+    std::vector<PackedVertex> vertices;
+    std::vector<SkinVertex> skin; // Skinned layout only
+    std::vector<uint32_t> indices;
+    std::vector<Meshlet> meshlets; // empty for meshes culled as a whole
+    AABB bounds;
+    std::vector<std::pair<Type, std::string>> textures; // relative to the model's directory
+};
+
+struct ModelNodeData
+{
+    std::string name;
+    int32_t parent = -1; // always lower than the node's own index
+    glm::vec3 position{0.0f};
+    glm::quat rotation{1.0f, 0.0f, 0.0f, 0.0f};
+    glm::vec3 scale{1.0f};
+    std::vector<uint32_t> meshes;
+};
+
+struct ModelData
+{
+    std::vector<ModelNodeData> nodes;
+    std::vector<ModelMeshData> meshes;
+};
+
+// .omdl: a flat image of ModelData that is used in place once mapped.
+// Every array is addressed by a byte offset from the start of the file.
+namespace ModelFormat
+{
+    constexpr char MAGIC[4] = {'O', 'M', 'D', 'L'};
+    constexpr uint32_t VERSION = 2;
+
+    struct Header
+    {
+        char magic[4];
+        uint32_t version;
+        uint64_t sourceHash;
+        uint32_t importFlags;
+        uint32_t nodeCount;
+        uint32_t meshCount;
+        uint32_t meshRefCount;
+        uint32_t textureCount;
+        uint32_t reserved;
+        uint64_t nodesOffset;
+        uint64_t meshRefsOffset;
+        uint64_t meshesOffset;
+        uint64_t texturesOffset;
+        uint64_t stringsOffset;
+        uint64_t stringsSize;
+        uint64_t fileSize;
+    };
+
+    struct Node
+    {
+        int32_t parent;
+        uint32_t nameOffset;
+        uint32_t nameLength;
+        uint32_t firstMeshRef;
+        uint32_t meshRefCount;
+        float position[3];
+        float rotation[4]; // w, x, y, z
+        float scale[3];
+    };
+
+    struct Mesh
+    {
+        uint32_t layout;
+        uint32_t vertexCount;
+        uint32_t indexCount;
+        uint32_t firstTexture;
+        uint32_t textureCount;
+        float boundsMin[3];
+        float boundsMax[3];
+        uint32_t meshletCount;
+        uint64_t verticesOffset;
+        uint64_t skinOffset; // 0 when not skinned
+        uint64_t indicesOffset;
+        uint64_t meshletsOffset;
+    };
+
+    struct TextureRef
+    {
+        uint32_t type;
+        uint32_t pathOffset;
+        uint32_t pathLength;
+    };
+
+    inline std::vector<uint8_t> Serialize(const ModelData &model, uint64_t sourceHash, uint32_t importFlags)
+    {
+        std::vector<Node> nodes;
+        std::vector<uint32_t> meshRefs;
+        std::vector<Mesh> meshes;
+        std::vector<TextureRef> textures;
+        std::string strings;
+
+        auto addString = [&strings](const std::string &text, uint32_t &offset, uint32_t &length)
+        {
+            offset = (uint32_t)strings.size();
+            length = (uint32_t)text.size();
+            strings += text;
+        };
+
+        for (auto &node : model.nodes)
+        {
+            Node out{};
+            out.parent = node.parent;
+            addString(node.name, out.nameOffset, out.nameLength);
+            out.firstMeshRef = (uint32_t)meshRefs.size();
+            out.meshRefCount = (uint32_t)node.meshes.size();
+            meshRefs.insert(meshRefs.end(), node.meshes.begin(), node.meshes.end());
+            std::memcpy(out.position, &node.position[0], sizeof(out.position));
+            out.rotation[0] = node.rotation.w;
+            out.rotation[1] = node.rotation.x;
+            out.rotation[2] = node.rotation.y;
+            out.rotation[3] = node.rotation.z;
+            std::memcpy(out.scale, &node.scale[0], sizeof(out.scale));
+            nodes.push_back(out);
+        }
+
+        for (auto &mesh : model.meshes)
+        {
+            Mesh out{};
+            out.layout = (uint32_t)mesh.layout;
+            out.vertexCount = (uint32_t)mesh.vertices.size();
+            out.indexCount = (uint32_t)mesh.indices.size();
+            out.firstTexture = (uint32_t)textures.size();
+            out.textureCount = (uint32_t)mesh.textures.size();
+            out.meshletCount = (uint32_t)mesh.meshlets.size();
+            std::memcpy(out.boundsMin, &mesh.bounds.min[0], sizeof(out.boundsMin));
+            std::memcpy(out.boundsMax, &mesh.bounds.max[0], sizeof(out.boundsMax));
+            for (auto &[type, path] : mesh.textures)
+            {
+                TextureRef ref{};
+                ref.type = (uint32_t)type;
+                addString(path, ref.pathOffset, ref.pathLength);
+                textures.push_back(ref);
+            }
+            meshes.push_back(out);
+        }
+
+        std::vector<uint8_t> bytes(sizeof(Header));
+        auto append = [&bytes](const void *data, size_t size) -> uint64_t
+        {
+            // 16 byte alignment keeps every array safe to use in place
+            bytes.resize((bytes.size() + 15) & ~size_t(15));
+            uint64_t offset = bytes.size();
+            if (size)
+            {
+                bytes.resize(bytes.size() + size);
+                std::memcpy(bytes.data() + offset, data, size);
+            }
+            return offset;
+        };
+
+        Header header{};
+        std::memcpy(header.magic, MAGIC, 4);
+        header.version = VERSION;
+        header.sourceHash = sourceHash;
+        header.importFlags = importFlags;
+        header.nodeCount = (uint32_t)nodes.size();
+        header.meshCount = (uint32_t)meshes.size();
+        header.meshRefCount = (uint32_t)meshRefs.size();
+        header.textureCount = (uint32_t)textures.size();
+
+        header.nodesOffset = append(nodes.data(), nodes.size() * sizeof(Node));
+        header.meshRefsOffset = append(meshRefs.data(), meshRefs.size() * sizeof(uint32_t));
+        header.texturesOffset = append(textures.data(), textures.size() * sizeof(TextureRef));
+        header.stringsOffset = append(strings.data(), strings.size());
+        header.stringsSize = strings.size();
+
+        // Vertex data last, then patch the mesh records with where it landed.
+        for (size_t i = 0; i < model.meshes.size(); ++i)
+        {
+            auto &src = model.meshes[i];
+            meshes[i].verticesOffset = append(src.vertices.data(), src.vertices.size() * sizeof(PackedVertex));
+            meshes[i].skinOffset = src.skin.empty() ? 0 : append(src.skin.data(), src.skin.size() * sizeof(SkinVertex));
+            meshes[i].indicesOffset = append(src.indices.data(), src.indices.size() * sizeof(uint32_t));
+            meshes[i].meshletsOffset = append(src.meshlets.data(), src.meshlets.size() * sizeof(Meshlet));
+        }
+        header.meshesOffset = append(meshes.data(), meshes.size() * sizeof(Mesh));
+
+        header.fileSize = bytes.size();
+        std::memcpy(bytes.data(), &header, sizeof(header));
+        return bytes;
+    }
+}
+
+// Read-only view of an .omdl image, either mapped from disk or freshly serialized.
+class ModelFile
+{
+public:
+    // Null when the file is missing, truncated or from another format version.
+    static std::shared_ptr<ModelFile> Open(const std::string &path)
+    {
+        auto file = std::shared_ptr<ModelFile>(new ModelFile());
+        if (!file->mapped.Open(path))
+            return nullptr;
+        file->data = file->mapped.Data();
+        file->size = file->mapped.Size();
+        if (!file->Validate())
+            return nullptr;
+        return file;
+    }
+
+    static std::shared_ptr<ModelFile> FromBytes(std::vector<uint8_t> bytes)
+    {
+        auto file = std::shared_ptr<ModelFile>(new ModelFile());
+        file->owned = std::move(bytes);
+        file->data = file->owned.data();
+        file->size = file->owned.size();
+        if (!file->Validate())
+            return nullptr;
+        return file;
+    }
+
+    // Writes through a temp file so an interrupted write never leaves a bad cache entry.
+    // The temp name is unique, a loader job and a synchronous load may import the same model.
+    static bool Write(const std::string &path, const std::vector<uint8_t> &bytes)
+    {
+        std::error_code ec;
+        std::filesystem::create_directories(std::filesystem::path(path).parent_path(), ec);
+
+        std::string temp = FileSystem::TempPath(path);
+        {
+            std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+            if (!out)
+                return false;
+            out.write(reinterpret_cast<const char *>(bytes.data()), (std::streamsize)bytes.size());
+            if (!out)
+                return false;
+        }
+
+        std::filesystem::rename(temp, path, ec);
+        if (ec)
+        {
+            std::filesystem::remove(temp, ec);
+            return false;
+        }
+        return true;
+    }
+
+    const ModelFormat::Header &GetHeader() const { return *At<ModelFormat::Header>(0); }
+
+    bool Matches(uint64_t sourceHash, uint32_t importFlags) const
+    {
+        return GetHeader().sourceHash == sourceHash && GetHeader().importFlags == importFlags;
+    }
+
+    uint32_t NodeCount() const { return GetHeader().nodeCount; }
+    uint32_t MeshCount() const { return GetHeader().meshCount; }
+
+    const ModelFormat::Node &GetNode(uint32_t i) const { return At<ModelFormat::Node>(GetHeader().nodesOffset)[i]; }
+    const ModelFormat::Mesh &GetMesh(uint32_t i) const { return At<ModelFormat::Mesh>(GetHeader().meshesOffset)[i]; }
+    const ModelFormat::TextureRef &GetTexture(uint32_t i) const { return At<ModelFormat::TextureRef>(GetHeader().texturesOffset)[i]; }
+    uint32_t GetMeshRef(uint32_t i) const { return At<uint32_t>(GetHeader().meshRefsOffset)[i]; }
+
+    std::string GetString(uint32_t offset, uint32_t length) const
+    {
+        return std::string(reinterpret_cast<const char *>(data + GetHeader().stringsOffset + offset), length);
+    }
+
+    const PackedVertex *GetVertices(const ModelFormat::Mesh &mesh) const { return At<PackedVertex>(mesh.verticesOffset); }
+    const SkinVertex *GetSkin(const ModelFormat::Mesh &mesh) const { return mesh.skinOffset ? At<SkinVertex>(mesh.skinOffset) : nullptr; }
+    const uint32_t *GetIndices(const ModelFormat::Mesh &mesh) const { return At<uint32_t>(mesh.indicesOffset); }
+    const Meshlet *GetMeshlets(const ModelFormat::Mesh &mesh) const { return At<Meshlet>(mesh.meshletsOffset); }
+
+private:
+    ModelFile() = default;
+
+    template <typename T>
+    const T *At(uint64_t offset) const
+    {
+        return reinterpret_cast<const T *>(data + offset);
+    }
+
+    bool InRange(uint64_t offset, uint64_t bytes) const
+    {
+        return offset <= size && bytes <= size - offset;
+    }
+
+    // Bounds checks only; contents are trusted once the ranges are sane.
+    bool Validate() const
+    {
+        if (size < sizeof(ModelFormat::Header))
+            return false;
+
+        const auto &h = GetHeader();
+        if (std::memcmp(h.magic, ModelFormat::MAGIC, 4) != 0 || h.version != ModelFormat::VERSION || h.fileSize != size)
+            return false;
+
+        if (!InRange(h.nodesOffset, (uint64_t)h.nodeCount * sizeof(ModelFormat::Node)) ||
+            !InRange(h.meshRefsOffset, (uint64_t)h.meshRefCount * sizeof(uint32_t)) ||
+            !InRange(h.meshesOffset, (uint64_t)h.meshCount * sizeof(ModelFormat::Mesh)) ||
+            !InRange(h.texturesOffset, (uint64_t)h.textureCount * sizeof(ModelFormat::TextureRef)) ||
+            !InRange(h.stringsOffset, h.stringsSize))
+            return false;
+
+        for (uint32_t i = 0; i < h.nodeCount; ++i)
+        {
+            const auto &node = GetNode(i);
+            if (node.parent >= (int32_t)i || (uint64_t)node.firstMeshRef + node.meshRefCount > h.meshRefCount ||
+                (uint64_t)node.nameOffset + node.nameLength > h.stringsSize)
+                return false;
+        }
+        for (uint32_t i = 0; i < h.meshRefCount; ++i)
+            if (GetMeshRef(i) >= h.meshCount)
+                return false;
+
+        for (uint32_t i = 0; i < h.meshCount; ++i)
+        {
+            const auto &mesh = GetMesh(i);
+            bool skinned = mesh.layout == (uint32_t)VertexLayout::Skinned;
+            if (mesh.layout > (uint32_t)VertexLayout::Skinned ||
+                (uint64_t)mesh.firstTexture + mesh.textureCount > h.textureCount ||
+                !InRange(mesh.verticesOffset, (uint64_t)mesh.vertexCount * sizeof(PackedVertex)) ||
+                !InRange(mesh.indicesOffset, (uint64_t)mesh.indexCount * sizeof(uint32_t)) ||
+                !InRange(mesh.meshletsOffset, (uint64_t)mesh.meshletCount * sizeof(Meshlet)) ||
+                (skinned && mesh.vertexCount && (!mesh.skinOffset || !InRange(mesh.skinOffset, (uint64_t)mesh.vertexCount * sizeof(SkinVertex)))))
+                return false;
+        }
+
+        // Meshlet ranges are drawn directly, so they must stay inside the mesh
+        for (uint32_t i = 0; i < h.meshCount; ++i)
+        {
+            const auto &mesh = GetMesh(i);
+            const Meshlet *meshlets = GetMeshlets(mesh);
+            for (uint32_t m = 0; m < mesh.meshletCount; ++m)
+                if ((uint64_t)meshlets[m].firstIndex + meshlets[m].indexCount > mesh.indexCount)
+                    return false;
+        }
+
+        for (uint32_t i = 0; i < h.textureCount; ++i)
+        {
+            const auto &ref = GetTexture(i);
+            if ((uint64_t)ref.pathOffset + ref.pathLength > h.stringsSize)
+                return false;
+        }
+        return true;
+    }
+
+    MappedFile mapped;
+    std::vector<uint8_t> owned;
+    const uint8_t *data = nullptr;
+    size_t size = 0;
+};
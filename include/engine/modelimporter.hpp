@@ -0,0 +1,444 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include <stdexcept>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <iomanip>
+
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+#include <assimp/postprocess.h>
+#include <assimp/IOSystem.hpp>
+#include <assimp/IOStream.hpp>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <engine/modelfile.hpp>
+#include <engine/filesystem.hpp>
+#include <engine/assetdatabase.hpp>
+#include <engine/hash.hpp>
+#include <engine/threadpool.hpp>
+#include <engine/tracer.hpp>
+#include <engine/render/meshoptimizer.hpp>
+#include <engine/buffers/geometry.hpp>
+#include <engine/configure.hpp>
+
+// Turns a source model file into the processed .omdl image, through the on-disk cache.
+class ModelImporter
+{
+public:
+    // Post-processing applied on import; part of the cache key.
+    static constexpr unsigned int IMPORT_FLAGS =
+        aiProcess_Triangulate |
+        aiProcess_GenNormals |
+        aiProcess_JoinIdenticalVertices; // triangle and vertex order: see MeshOptimizer
+
+    // Import flags and output format together; an import is redone when either changes.
+    static constexpr uint64_t IMPORT_SETTINGS = ((uint64_t)ModelFormat::VERSION << 32) | IMPORT_FLAGS;
+
+    // Returns the processed model for path, importing it with Assimp only when the
+    // .omdl cache entry is missing, or the model or any file it pulled in (e.g. an
+    // .mtl) changed since. Unchanged sources are not even re-hashed, see AssetDatabase.
+    static std::shared_ptr<ModelFile> LoadCached(const std::string &path)
+    {
+        AssetDatabase &database = AssetDatabase::Get();
+
+        uint64_t sourceHash = 0;
+        {
+            TRACE_SCOPE("Model source hash", path);
+            if (!database.ContentHash(path, sourceHash))
+                throw std::runtime_error("Failed to open model: " + path);
+        }
+
+        const std::string cachePath = CachePath(path);
+        {
+            TRACE_SCOPE("Model cache read", path);
+            if (database.IsUpToDate(cachePath, IMPORT_SETTINGS))
+                if (auto cached = ModelFile::Open(cachePath))
+                    if (cached->Matches(sourceHash, IMPORT_FLAGS))
+                        return cached;
+        }
+
+        std::vector<std::string> inputs{path};
+        ModelData model = Import(path, inputs);
+
+        TRACE_SCOPE("Model cache write", path);
+        std::vector<uint8_t> bytes = ModelFormat::Serialize(model, sourceHash, IMPORT_FLAGS);
+        if (ModelFile::Write(cachePath, bytes))
+            database.RecordImport(cachePath, IMPORT_SETTINGS, inputs);
+        else
+            std::cout << "[ModelImporter] Cannot write model cache: " << cachePath << std::endl;
+
+        return ModelFile::FromBytes(std::move(bytes));
+    }
+
+private:
+    // Lets Assimp, and any files a format references, read through FileSystem.
+    // Every file opened is appended to opened, once, as an input of the import.
+    class FileSystemIO : public Assimp::IOSystem
+    {
+    public:
+        explicit FileSystemIO(std::vector<std::string> &opened) : opened(opened) {}
+
+        bool Exists(const char *file) const override
+        {
+            return FileSystem::Get().Exists(file);
+        }
+
+        char getOsSeparator() const override { return '/'; }
+
+        Assimp::IOStream *Open(const char *file, const char *mode = "rb") override
+        {
+            // Read only, the importer never writes
+            if (std::strchr(mode, 'w') || std::strchr(mode, 'a'))
+                return nullptr;
+
+            FileView view = FileSystem::Get().Open(file);
+            if (!view.IsOpen())
+                return nullptr;
+
+            std::string normal = PackFormat::NormalizePath(file);
+            if (std::none_of(opened.begin(), opened.end(), [&](const std::string &p)
+                             { return PackFormat::NormalizePath(p) == normal; }))
+                opened.push_back(normal);
+
+            return new Stream(std::move(view));
+        }
+
+        void Close(Assimp::IOStream *stream) override
+        {
+            delete stream;
+        }
+
+    private:
+        class Stream : public Assimp::IOStream
+        {
+        public:
+            explicit Stream(FileView view) : view(std::move(view)) {}
+
+            size_t Read(void *buffer, size_t size, size_t count) override
+            {
+                if (size == 0)
+                    return 0;
+                count = std::min(count, (view.Size() - cursor) / size);
+                std::memcpy(buffer, view.Data() + cursor, size * count);
+                cursor += size * count;
+                return count;
+            }
+
+            size_t Write(const void *, size_t, size_t) override { return 0; }
+
+            aiReturn Seek(size_t offset, aiOrigin origin) override
+            {
+                size_t base = origin == aiOrigin_CUR ? cursor : origin == aiOrigin_END ? view.Size() : 0;
+                if (origin == aiOrigin_END ? offset > base : base + offset > view.Size())
+                    return aiReturn_FAILURE;
+                cursor = origin == aiOrigin_END ? base - offset : base + offset;
+                return aiReturn_SUCCESS;
+            }
+
+            size_t Tell() const override { return cursor; }
+            size_t FileSize() const override { return view.Size(); }
+            void Flush() override {}
+
+        private:
+            FileView view;
+            size_t cursor = 0;
+        };
+
+        std::vector<std::string> &opened;
+    };
+
+    static std::string CachePath(const std::string &path)
+    {
+        std::error_code ec;
+        std::filesystem::path canonical = std::filesystem::weakly_canonical(path, ec);
+        std::string key = (ec ? std::filesystem::path(path).lexically_normal() : canonical).generic_string();
+
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.omdl", (unsigned long long)Hash::Fnv1a(key));
+        return (std::filesystem::path(ASSET_CACHE_DIR) / "models" / name).string();
+    }
+
+    // -------------------------------
+    // ASSIMP → MODEL DATA
+    // -------------------------------
+    static ModelData Import(const std::string &path, std::vector<std::string> &inputs)
+    {
+        Assimp::Importer importer;
+        importer.SetIOHandler(new FileSystemIO(inputs)); // owned by the importer
+
+        const aiScene *aiScene = nullptr;
+        {
+            TRACE_SCOPE("Assimp read", path);
+            aiScene = importer.ReadFile(path, IMPORT_FLAGS);
+        }
+
+        if (!aiScene || !aiScene->mRootNode)
+        {
+            throw std::runtime_error("Assimp failed to load model: " + path);
+        }
+
+        // Meshes are independent once Assimp has post-processed the scene, so
+        // conversion, bounds and index flattening run one aiMesh per worker.
+        ModelData model;
+        model.meshes.resize(aiScene->mNumMeshes);
+        std::vector<MeshOptimizer::Report> reports(aiScene->mNumMeshes);
+        {
+            TRACE_SCOPE("Mesh conversion", path);
+            ThreadPool::Get().ParallelFor(aiScene->mNumMeshes, [&](size_t i)
+                                          { model.meshes[i] = ProcessMesh(aiScene->mMeshes[i], aiScene, reports[i]); });
+        }
+
+        for (size_t i = 0; i < reports.size(); i++)
+            PrintReport(path, i, model.meshes[i], reports[i]);
+
+        ProcessNode(aiScene->mRootNode, -1, model);
+        return model;
+    }
+
+    // -------------------------------
+    // NODE
+    // -------------------------------
+    static void ProcessNode(
+        aiNode *node,
+        int32_t parent,
+        ModelData &model)
+    {
+        ModelNodeData out;
+        out.name = node->mName.C_Str();
+        out.parent = parent;
+        ApplyTransform(node->mTransformation, out);
+
+        // Meshes
+        for (unsigned int i = 0; i < node->mNumMeshes; i++)
+            out.meshes.push_back(node->mMeshes[i]);
+
+        int32_t index = (int32_t)model.nodes.size();
+        model.nodes.push_back(std::move(out));
+
+        // Children
+        for (unsigned int i = 0; i < node->mNumChildren; i++)
+            ProcessNode(node->mChildren[i], index, model);
+    }
+
+    // -------------------------------
+    // TRANSFORM
+    // -------------------------------
+    static void ApplyTransform(
+        const aiMatrix4x4 &m,
+        ModelNodeData &node)
+    {
+        aiVector3D pos, scale;
+        aiQuaternion rot;
+        m.Decompose(scale, rot, pos);
+
+        node.position = {pos.x, pos.y, pos.z};
+        node.scale = {scale.x, scale.y, scale.z};
+        node.rotation = glm::quat(rot.w, rot.x, rot.y, rot.z);
+    }
+
+    // -------------------------------
+    // MESH
+    // -------------------------------
+    // Only reads the aiScene, safe to call concurrently.
+    static ModelMeshData ProcessMesh(
+        const aiMesh *mesh,
+        const aiScene *scene,
+        MeshOptimizer::Report &report)
+    {
+        std::vector<Vertex> vertices;
+        ModelMeshData out;
+
+        vertices.reserve(mesh->mNumVertices);
+
+        // Vertices
+        for (unsigned int i = 0; i < mesh->mNumVertices; i++)
+        {
+            Vertex v{};
+            v.position = {
+                mesh->mVertices[i].x,
+                mesh->mVertices[i].y,
+                mesh->mVertices[i].z};
+
+            if (mesh->HasNormals())
+            {
+                v.normal = {
+                    mesh->mNormals[i].x,
+                    mesh->mNormals[i].y,
+                    mesh->mNormals[i].z};
+            }
+
+            if (mesh->mTextureCoords[0])
+            {
+                v.uv = {
+                    mesh->mTextureCoords[0][i].x,
+                    mesh->mTextureCoords[0][i].y};
+            }
+
+            vertices.push_back(v);
+        }
+
+        // Bone influences, up to MAX_BONE_INFLUENCE per vertex keeping the heaviest
+        if (mesh->HasBones())
+        {
+            out.layout = VertexLayout::Skinned;
+            AppendBoneWeights(vertices, mesh);
+        }
+
+        // Indices
+        out.indices.reserve((size_t)mesh->mNumFaces * 3);
+        for (unsigned int i = 0; i < mesh->mNumFaces; i++)
+        {
+            const aiFace &face = mesh->mFaces[i];
+            for (unsigned int j = 0; j < face.mNumIndices; j++)
+                out.indices.push_back(face.mIndices[j]);
+        }
+
+        Optimize(vertices, out.indices, report);
+
+        // Dense static meshes are also culled per meshlet at draw time; skinned
+        // ones move away from their bind-pose bounds
+        if (out.layout == VertexLayout::Static && out.indices.size() / 3 >= Meshlets::MIN_MESH_TRIANGLES)
+        {
+            std::vector<glm::vec3> positions;
+            positions.reserve(vertices.size());
+            for (auto &v : vertices)
+                positions.push_back(v.position);
+            out.meshlets = Meshlets::Build(out.indices, positions);
+        }
+
+        // Final GPU layout
+        out.vertices.reserve(vertices.size());
+        for (auto &v : vertices)
+        {
+            out.vertices.push_back(PackVertex(v));
+            out.bounds.Expand(v.position);
+        }
+        if (out.layout == VertexLayout::Skinned)
+        {
+            out.skin.reserve(vertices.size());
+            for (auto &v : vertices)
+                out.skin.push_back(PackSkin(v));
+        }
+
+        // Materials
+        if (mesh->mMaterialIndex < scene->mNumMaterials)
+        {
+            const aiMaterial *material = scene->mMaterials[mesh->mMaterialIndex];
+
+            AppendMaterialTextures(
+                out.textures,
+                material,
+                aiTextureType_DIFFUSE,
+                Type::DIFFUSE);
+
+            AppendMaterialTextures(
+                out.textures,
+                material,
+                aiTextureType_SPECULAR,
+                Type::SPECULAR);
+        }
+
+        return out;
+    }
+
+    // Vertex cache order, then overdraw order, then vertices renumbered in the
+    // order the triangles fetch them (unreferenced ones dropped).
+    static void Optimize(std::vector<Vertex> &vertices, std::vector<uint32_t> &indices, MeshOptimizer::Report &report)
+    {
+        std::vector<glm::vec3> positions;
+        positions.reserve(vertices.size());
+        for (auto &v : vertices)
+            positions.push_back(v.position);
+
+        report.cacheBefore = MeshOptimizer::AnalyzeVertexCache(indices, vertices.size());
+        report.overdrawBefore = MeshOptimizer::AnalyzeOverdraw(indices, positions);
+
+        MeshOptimizer::OptimizeVertexCache(indices, vertices.size());
+        MeshOptimizer::OptimizeOverdraw(indices, positions);
+
+        size_t used = 0;
+        std::vector<uint32_t> remap = MeshOptimizer::OptimizeVertexFetch(indices, vertices.size(), used);
+
+        std::vector<Vertex> reordered(used);
+        std::vector<glm::vec3> reorderedPositions(used);
+        for (size_t i = 0; i < vertices.size(); i++)
+            if (remap[i] != ~0u)
+            {
+                reordered[remap[i]] = vertices[i];
+                reorderedPositions[remap[i]] = positions[i];
+            }
+        vertices.swap(reordered);
+
+        report.cacheAfter = MeshOptimizer::AnalyzeVertexCache(indices, vertices.size());
+        report.overdrawAfter = MeshOptimizer::AnalyzeOverdraw(indices, reorderedPositions);
+    }
+
+    static void PrintReport(const std::string &path, size_t index, const ModelMeshData &mesh, const MeshOptimizer::Report &report)
+    {
+        std::streamsize precision = std::cout.precision();
+        std::cout << std::fixed << std::setprecision(3)
+                  << "[ModelImporter] " << path << " mesh " << index << ": "
+                  << mesh.indices.size() / 3 << " tris, " << mesh.vertices.size() << " verts, "
+                  << (GeometryAllocator::NeedsWideIndices((uint32_t)mesh.vertices.size()) ? "32" : "16") << " bit indices"
+                  << " | ACMR " << report.cacheBefore.acmr << " -> " << report.cacheAfter.acmr
+                  << " | ATVR " << report.cacheBefore.atvr << " -> " << report.cacheAfter.atvr
+                  << " | overdraw " << report.overdrawBefore << " -> " << report.overdrawAfter
+                  << " | " << mesh.meshlets.size() << " meshlets"
+                  << std::defaultfloat << std::setprecision(precision) << std::endl;
+    }
+
+    static void AppendBoneWeights(std::vector<Vertex> &vertices, const aiMesh *mesh)
+    {
+        // Skin stream stores uint8 bone indices
+        unsigned int boneCount = std::min(mesh->mNumBones, 256u);
+
+        for (unsigned int b = 0; b < boneCount; b++)
+        {
+            const aiBone *bone = mesh->mBones[b];
+            for (unsigned int w = 0; w < bone->mNumWeights; w++)
+            {
+                const aiVertexWeight &weight = bone->mWeights[w];
+                if (weight.mVertexId >= vertices.size())
+                    continue;
+
+                Vertex &v = vertices[weight.mVertexId];
+                int lightest = 0;
+                for (int i = 1; i < MAX_BONE_INFLUENCE; i++)
+                    if (v.weights[i] < v.weights[lightest])
+                        lightest = i;
+
+                if (weight.mWeight > v.weights[lightest])
+                {
+                    v.boneIDs[lightest] = (int)b;
+                    v.weights[lightest] = weight.mWeight;
+                }
+            }
+        }
+    }
+
+    // -------------------------------
+    // TEXTURES
+    // -------------------------------
+    static void AppendMaterialTextures(
+        std::vector<std::pair<Type, std::string>> &out,
+        const aiMaterial *material,
+        aiTextureType type,
+        Type engineType)
+    {
+        for (unsigned int i = 0; i < material->GetTextureCount(type); i++)
+        {
+            aiString str;
+            material->GetTexture(type, i, &str);
+
+            out.emplace_back(engineType, str.C_Str());
+        }
+    }
+};
@@ -0,0 +1,175 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <engine/glext.hpp>
+#include <engine/shader.hpp>
+#include <engine/components/mesh.hpp>
+#include <engine/buffers/geometry.hpp>
+
+// Collects a pass's draws and submits them grouped by geometry pool and material.
+// With GL 4.3 each group is one glMultiDrawElementsIndirect call and model matrices
+// come from the instance buffer; on 3.3 it falls back to one base-vertex draw each.
+class DrawBatcher
+{
+public:
+    DrawBatcher()
+    {
+        glGenBuffers(1, &indirectBuffer);
+    }
+
+    ~DrawBatcher()
+    {
+        if (indirectBuffer)
+            glDeleteBuffers(1, &indirectBuffer);
+    }
+
+    DrawBatcher(const DrawBatcher &) = delete;
+    DrawBatcher &operator=(const DrawBatcher &) = delete;
+
+    void Begin()
+    {
+        items.clear();
+    }
+
+    void Add(Mesh *mesh, const glm::mat4 &model)
+    {
+        items.push_back({mesh, model, 0, mesh->GetIndexCount()});
+    }
+
+    // Draws only [firstIndex, firstIndex + indexCount) of the mesh, e.g. its visible meshlets.
+    void Add(Mesh *mesh, const glm::mat4 &model, uint32_t firstIndex, uint32_t indexCount)
+    {
+        items.push_back({mesh, model, firstIndex, indexCount});
+    }
+
+    // bindMaterials is false for depth-only passes, which only batch by pool.
+    void Flush(const Shader &shader, bool bindMaterials)
+    {
+        if (items.empty())
+            return;
+
+        std::sort(items.begin(), items.end(), [bindMaterials](const Item &a, const Item &b)
+                  {
+            GeometryPool *pa = &a.mesh->GetPool();
+            GeometryPool *pb = &b.mesh->GetPool();
+            if (pa != pb)
+                return pa < pb;
+            return bindMaterials && a.mesh->GetMaterialKey() < b.mesh->GetMaterialKey(); });
+
+        shader.Use();
+
+        if (GLExt::SupportsMultiDrawIndirect())
+            SubmitIndirect(shader, bindMaterials);
+        else
+            SubmitDirect(shader, bindMaterials);
+
+        GeometryPool::Unbind();
+        drawCount = items.size();
+        items.clear();
+    }
+
+    size_t GetLastDrawCount() const { return drawCount; }
+    size_t GetLastBatchCount() const { return batchCount; }
+
+private:
+    struct Item
+    {
+        Mesh *mesh;
+        glm::mat4 model;
+        uint32_t firstIndex;
+        uint32_t indexCount;
+    };
+
+    bool StartsBatch(size_t i, bool bindMaterials) const
+    {
+        if (i == 0)
+            return true;
+        const Mesh &prev = *items[i - 1].mesh;
+        const Mesh &cur = *items[i].mesh;
+        if (&prev.GetPool() != &cur.GetPool())
+            return true;
+        return bindMaterials && !cur.SharesMaterial(prev);
+    }
+
+    void SubmitIndirect(const Shader &shader, bool bindMaterials)
+    {
+        commands.clear();
+        matrices.clear();
+        commands.reserve(items.size());
+        matrices.reserve(items.size());
+
+        for (size_t i = 0; i < items.size(); ++i)
+        {
+            const Item &item = items[i];
+            const GeometryAllocation &a = item.mesh->GetAllocation();
+            commands.push_back({item.indexCount, 1, a.firstIndex + item.firstIndex, (GLint)a.baseVertex, (GLuint)i});
+            matrices.push_back(items[i].model);
+        }
+
+        // Orphan and refill; the instance buffer's name stays bound in every pool VAO.
+        glBindBuffer(GL_ARRAY_BUFFER, GeometryAllocator::Get().GetInstanceBuffer());
+        glBufferData(GL_ARRAY_BUFFER, matrices.size() * sizeof(glm::mat4), matrices.data(), GL_STREAM_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, commands.size() * sizeof(DrawElementsIndirectCommand), commands.data(), GL_STREAM_DRAW);
+
+        shader.SetUniform("uIndirect", 1);
+
+        batchCount = 0;
+        size_t first = 0;
+        for (size_t i = 1; i <= items.size(); ++i)
+        {
+            if (i < items.size() && !StartsBatch(i, bindMaterials))
+                continue;
+
+            const Mesh &mesh = *items[first].mesh;
+            mesh.GetPool().Bind();
+            if (bindMaterials)
+                mesh.BindMaterial(shader);
+
+            GLExt::MultiDrawElementsIndirect(
+                GL_TRIANGLES,
+                mesh.GetPool().GetIndexType(),
+                (void *)(first * sizeof(DrawElementsIndirectCommand)),
+                (GLsizei)(i - first),
+                0);
+
+            batchCount++;
+            first = i;
+        }
+
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    }
+
+    void SubmitDirect(const Shader &shader, bool bindMaterials)
+    {
+        shader.SetUniform("uIndirect", 0);
+
+        batchCount = 0;
+        for (size_t i = 0; i < items.size(); ++i)
+        {
+            const Mesh &mesh = *items[i].mesh;
+            if (StartsBatch(i, bindMaterials))
+            {
+                mesh.GetPool().Bind();
+                if (bindMaterials)
+                    mesh.BindMaterial(shader);
+                batchCount++;
+            }
+
+            shader.SetUniform("model", items[i].model);
+            mesh.DrawElements(items[i].firstIndex, items[i].indexCount);
+        }
+    }
+
+    std::vector<Item> items;
+    std::vector<DrawElementsIndirectCommand> commands;
+    std::vector<glm::mat4> matrices;
+    GLuint indirectBuffer = 0;
+
+    size_t drawCount = 0;
+    size_t batchCount = 0;
+};
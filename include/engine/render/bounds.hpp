@@ -0,0 +1,31 @@
+#pragma once
+#include <cfloat>
+#include <glm/glm.hpp>
+
+struct AABB
+{
+    glm::vec3 min{FLT_MAX};
+    glm::vec3 max{-FLT_MAX};
+
+    bool IsValid() const
+    {
+        return min.x <= max.x && min.y <= max.y && min.z <= max.z;
+    }
+
+    void Expand(const glm::vec3 &p)
+    {
+        min = glm::min(min, p);
+        max = glm::max(max, p);
+    }
+
+    glm::vec3 Center() const { return (min + max) * 0.5f; }
+    glm::vec3 Extents() const { return (max - min) * 0.5f; }
+
+    glm::vec3 Corner(int i) const
+    {
+        return {
+            (i & 1) ? max.x : min.x,
+            (i & 2) ? max.y : min.y,
+            (i & 4) ? max.z : min.z};
+    }
+};
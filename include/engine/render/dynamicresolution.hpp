@@ -0,0 +1,95 @@
+#pragma once
+#include <glad/glad.h>
+#include <algorithm>
+#include <cmath>
+
+// Picks a render scale from GPU frame time measured with GL_TIME_ELAPSED queries.
+// Queries are read back a few frames late so the CPU never waits on the GPU.
+class DynamicResolution
+{
+public:
+    static constexpr int QUERY_COUNT = 4;
+
+    float targetFrameMs = 16.0f;
+    float minScale = 0.5f;
+    float maxScale = 1.0f;
+
+    DynamicResolution()
+    {
+        glGenQueries(QUERY_COUNT, queries);
+    }
+
+    ~DynamicResolution()
+    {
+        glDeleteQueries(QUERY_COUNT, queries);
+    }
+
+    DynamicResolution(const DynamicResolution &) = delete;
+    DynamicResolution &operator=(const DynamicResolution &) = delete;
+
+    void BeginFrame()
+    {
+        glBeginQuery(GL_TIME_ELAPSED, queries[current]);
+    }
+
+    void EndFrame()
+    {
+        glEndQuery(GL_TIME_ELAPSED);
+        pending[current] = true;
+        current = (current + 1) % QUERY_COUNT;
+
+        // The slot we'll write next frame is the oldest one in flight.
+        if (!pending[current])
+            return;
+
+        GLint available = 0;
+        glGetQueryObjectiv(queries[current], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+            return;
+
+        GLuint64 elapsed = 0;
+        glGetQueryObjectui64v(queries[current], GL_QUERY_RESULT, &elapsed);
+        pending[current] = false;
+
+        AddSample(static_cast<float>(elapsed) / 1.0e6f);
+    }
+
+    // Feeds one GPU frame time sample (ms) into the controller.
+    void AddSample(float gpuMs)
+    {
+        lastGpuMs = gpuMs;
+        smoothedMs = smoothedMs <= 0.0f ? gpuMs : smoothedMs + (gpuMs - smoothedMs) * SMOOTHING;
+
+        // Deadband around the target so the scale doesn't hunt.
+        float ratio = targetFrameMs / std::max(smoothedMs, 0.01f);
+        if (ratio > 1.0f - DEADBAND && ratio < 1.0f + DEADBAND)
+            return;
+
+        // Pixel count scales with scale^2, so step by the square root of the ratio.
+        float step = std::clamp(std::sqrt(ratio), 1.0f - MAX_STEP, 1.0f + MAX_STEP);
+        scale = std::clamp(scale * step, minScale, maxScale);
+    }
+
+    float GetScale() const { return scale; }
+    float GetLastGpuMs() const { return lastGpuMs; }
+    float GetSmoothedGpuMs() const { return smoothedMs; }
+
+    void Reset()
+    {
+        scale = maxScale;
+        smoothedMs = 0.0f;
+    }
+
+private:
+    static constexpr float SMOOTHING = 0.15f;
+    static constexpr float DEADBAND = 0.08f;
+    static constexpr float MAX_STEP = 0.05f;
+
+    GLuint queries[QUERY_COUNT] = {};
+    bool pending[QUERY_COUNT] = {};
+    int current = 0;
+
+    float scale = 1.0f;
+    float lastGpuMs = 0.0f;
+    float smoothedMs = 0.0f;
+};
@@ -0,0 +1,62 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <glm/glm.hpp>
+
+// A run of a mesh's triangles small enough to cull on its own. Triangles are not
+// copied: each meshlet is a contiguous range of the mesh's index buffer.
+struct Meshlet
+{
+    glm::vec3 center; // bounding sphere, mesh space
+    float radius;
+    glm::vec3 coneAxis; // average facing of the triangles
+    float coneCutoff;   // sine of the cone's half angle; 1 disables back-face culling
+    uint32_t firstIndex; // relative to the mesh's own index range
+    uint32_t indexCount;
+};
+
+struct IndexRange
+{
+    uint32_t firstIndex;
+    uint32_t indexCount;
+};
+
+namespace Meshlets
+{
+    constexpr uint32_t MAX_VERTICES = 64;
+    constexpr uint32_t MAX_TRIANGLES = 124;
+
+    // Meshes with fewer triangles are culled as a whole.
+    constexpr size_t MIN_MESH_TRIANGLES = 2048;
+
+    // Splits the index buffer, in its existing order, into meshlets.
+    std::vector<Meshlet> Build(const std::vector<uint32_t> &indices, const std::vector<glm::vec3> &positions);
+}
+
+// Per-view meshlet culling against the frustum and each meshlet's normal cone,
+// producing the index ranges still worth drawing.
+class MeshletCuller
+{
+public:
+    struct Stats
+    {
+        size_t meshlets = 0;
+        size_t frustumCulled = 0;
+        size_t backfaceCulled = 0;
+        size_t triangles = 0;
+        size_t visibleTriangles = 0;
+    };
+
+    void Begin(const glm::mat4 &viewProjection, const glm::vec3 &cameraPosition);
+
+    // Appends visible ranges for a mesh placed at model, merging adjacent meshlets.
+    void Cull(const std::vector<Meshlet> &meshlets, const glm::mat4 &model, std::vector<IndexRange> &out);
+
+    const Stats &GetStats() const { return stats; }
+
+private:
+    glm::vec4 planes[6];
+    glm::vec3 camera{0.0f};
+    Stats stats;
+};
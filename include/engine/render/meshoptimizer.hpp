@@ -0,0 +1,43 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <glm/glm.hpp>
+
+// Import-time triangle and vertex ordering for the GPU's post-transform vertex
+// cache, early depth rejection and vertex fetch. Works on 32 bit indices; the
+// geometry pools narrow them to 16 bit on upload where the vertex count allows.
+namespace MeshOptimizer
+{
+    // FIFO size used for the ACMR/ATVR metrics, close to what current GPUs reuse.
+    constexpr uint32_t ANALYSIS_CACHE_SIZE = 16;
+
+    struct CacheStats
+    {
+        float acmr = 0.0f; // vertex shader invocations per triangle, 0.5 - 3
+        float atvr = 0.0f; // invocations per referenced vertex, 1 is ideal
+    };
+
+    struct Report
+    {
+        CacheStats cacheBefore, cacheAfter;
+        float overdrawBefore = 0.0f, overdrawAfter = 0.0f; // shaded / covered pixels
+    };
+
+    // Reorders triangles for vertex reuse (Forsyth, linear-speed vertex cache
+    // optimisation with a 32 entry LRU model).
+    void OptimizeVertexCache(std::vector<uint32_t> &indices, size_t vertexCount);
+
+    // Splits the cache optimised order into clusters and draws outward facing
+    // ones first, keeping the ACMR within threshold times the input's.
+    void OptimizeOverdraw(std::vector<uint32_t> &indices, const std::vector<glm::vec3> &positions, float threshold = 1.05f);
+
+    // Renumbers vertices in first use order and rewrites indices to match.
+    // Returns the old -> new map, ~0u for vertices no triangle references.
+    std::vector<uint32_t> OptimizeVertexFetch(std::vector<uint32_t> &indices, size_t vertexCount, size_t &usedVertices);
+
+    CacheStats AnalyzeVertexCache(const std::vector<uint32_t> &indices, size_t vertexCount, uint32_t cacheSize = ANALYSIS_CACHE_SIZE);
+
+    // Rasterizes the mesh from the six axis directions in submission order.
+    float AnalyzeOverdraw(const std::vector<uint32_t> &indices, const std::vector<glm::vec3> &positions);
+}
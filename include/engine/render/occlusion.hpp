@@ -0,0 +1,87 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <glm/glm.hpp>
+#include <engine/render/bounds.hpp>
+
+// CPU occlusion culler: occluder triangles are rasterized into a low resolution
+// software depth buffer (split into horizontal bands across the ThreadPool), which
+// is then reduced into a per-tile max-depth hierarchy that bounds are tested against.
+// Has no GL dependency so it can be driven headlessly.
+class OcclusionCuller
+{
+public:
+    static constexpr int TILE_SIZE = 8;
+
+    struct Stats
+    {
+        size_t occluderTriangles = 0;
+        size_t rasterizedTriangles = 0;
+        size_t tested = 0;
+        size_t culled = 0;
+    };
+
+    explicit OcclusionCuller(int width = 256, int height = 128);
+
+    void Resize(int width, int height);
+
+    // Clears the depth buffer and queued occluders for a new view.
+    void Begin(const glm::mat4 &viewProjection);
+
+    // Queues an occluder; the data must stay alive until Rasterize returns.
+    void AddOccluder(
+        const glm::mat4 &model,
+        const glm::vec3 *positions,
+        size_t vertexCount,
+        const uint32_t *indices,
+        size_t indexCount);
+
+    // Transforms and rasterizes every queued occluder, then builds the depth hierarchy.
+    void Rasterize();
+
+    // Conservative test of a local-space box against the frustum and the occluders.
+    bool IsVisible(const AABB &localBounds, const glm::mat4 &model);
+
+    bool HasOccluders() const { return !occluders.empty(); }
+    int GetWidth() const { return width; }
+    int GetHeight() const { return height; }
+    const std::vector<float> &GetDepth() const { return depth; }
+    const Stats &GetStats() const { return stats; }
+
+private:
+    struct Occluder
+    {
+        glm::mat4 model;
+        const glm::vec3 *positions;
+        size_t vertexCount;
+        const uint32_t *indices;
+        size_t indexCount;
+    };
+
+    // Screen-space triangle, x/y in pixels, z in [0, 1].
+    struct ScreenTriangle
+    {
+        glm::vec3 v[3];
+        int minY, maxY;
+    };
+
+    void TransformOccluder(const Occluder &occluder, std::vector<ScreenTriangle> &out) const;
+    void RasterizeBand(int y0, int y1);
+    void RasterizeTriangle(const ScreenTriangle &tri, int y0, int y1);
+    void BuildHierarchy(int tileRow0, int tileRow1);
+
+    int width = 0, height = 0;
+    int stride = 0; // row pitch, padded to the SIMD width
+    int tilesX = 0, tilesY = 0;
+
+    glm::mat4 viewProjection{1.0f};
+
+    std::vector<float> depth;     // nearest occluder depth per pixel
+    std::vector<float> hierarchy; // farthest occluder depth per tile
+
+    std::vector<Occluder> occluders;
+    std::vector<std::vector<ScreenTriangle>> triangles;
+
+    Stats stats;
+};
@@ -0,0 +1,70 @@
+#pragma once
+#include <engine/shadercache.hpp>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Compile-time features of a scene shader; each one is a #define in the source.
+enum ShaderFeature : uint32_t
+{
+    SHADER_SHADOWS = 1 << 0,      // SHADOWS
+    SHADER_SPECULAR_MAP = 1 << 1, // SPECULAR_MAP
+    SHADER_UNLIT = 1 << 2         // UNLIT
+};
+
+struct ShaderVariantKey
+{
+    uint32_t features = 0;
+    uint32_t maxLights = 16;
+
+    uint64_t Packed() const { return ((uint64_t)maxLights << 32) | features; }
+    bool operator==(const ShaderVariantKey &other) const { return Packed() == other.Packed(); }
+};
+
+// Compiles variants of one shader file on first use and keeps them for reuse.
+class ShaderVariants
+{
+public:
+    explicit ShaderVariants(const std::string &filepath)
+        : source(Shader::ReadSource(filepath))
+    {
+    }
+
+    Shader &Get(const ShaderVariantKey &key)
+    {
+        auto it = variants.find(key.Packed());
+        if (it != variants.end())
+            return *it->second;
+
+        std::vector<std::string> defines;
+        if (key.features & SHADER_SHADOWS)
+            defines.push_back("SHADOWS");
+        if (key.features & SHADER_SPECULAR_MAP)
+            defines.push_back("SPECULAR_MAP");
+        if (key.features & SHADER_UNLIT)
+            defines.push_back("UNLIT");
+        defines.push_back("MAX_LIGHTS " + std::to_string(key.maxLights));
+
+        auto shader = ShaderCache::Get().Load(Shader::WithDefines(source, defines));
+        variants[key.Packed()] = shader;
+        return *shader;
+    }
+
+    // Light array sizes are bucketed so light count changes don't recompile every frame.
+    static uint32_t LightBucket(size_t lightCount)
+    {
+        if (lightCount <= 4)
+            return 4;
+        if (lightCount <= 8)
+            return 8;
+        return 16;
+    }
+
+    size_t Count() const { return variants.size(); }
+
+private:
+    Shader::Source source;
+    std::unordered_map<uint64_t, std::shared_ptr<Shader>> variants;
+};
@@ -0,0 +1,57 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// CPU side of a texture: either one uncompressed level (mips generated by the
+// driver) or a full block-compressed mip chain read from / written to the cache.
+
+enum class TextureCodec : uint32_t
+{
+    None, // uncompressed 8 bit, 1 or 4 channels
+    BC1,  // RGB, 4 bpp
+    BC3,  // RGBA, 8 bpp
+    BC4   // single channel, 4 bpp
+};
+
+struct TextureLevel
+{
+    int width = 0;
+    int height = 0;
+    std::vector<uint8_t> data;
+};
+
+struct TextureData
+{
+    int width = 0;
+    int height = 0;
+    int channels = 0; // channels in the source file
+    bool srgb = false;
+    TextureCodec codec = TextureCodec::None;
+    std::vector<TextureLevel> levels;
+
+    size_t ByteSize() const
+    {
+        size_t size = 0;
+        for (auto &level : levels)
+            size += level.data.size();
+        return size;
+    }
+};
+
+namespace TextureCompiler
+{
+    // Decodes an image file into one uncompressed level (1 or 4 channels, flipped for GL).
+    TextureData Decode(const std::string &path, bool srgb);
+
+    // Returns the block-compressed mip chain for path, building and caching it
+    // under ASSET_CACHE_DIR the first time or whenever the source changes.
+    TextureData LoadCompressed(const std::string &path, bool srgb);
+
+    // Builds a compressed mip chain from an uncompressed level 0.
+    TextureData Compress(const TextureData &source);
+
+    void EncodeBC1(const uint8_t rgba[64], uint8_t out[8]);
+    void EncodeBC3(const uint8_t rgba[64], uint8_t out[16]);
+    void EncodeBC4(const uint8_t values[16], uint8_t out[8]);
+}
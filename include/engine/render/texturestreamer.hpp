@@ -0,0 +1,156 @@
+#pragma once
+#include <engine/singleton.hpp>
+#include <engine/threadpool.hpp>
+#include <engine/texture2D.hpp>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+
+// Decodes textures on the thread pool and uploads them from the GL thread through
+// a pixel buffer, a limited number of bytes per frame. Until then the texture
+// binds the grey placeholder.
+class TextureStreamer : public Singleton<TextureStreamer>
+{
+    friend class Singleton<TextureStreamer>; // REQUIRED
+
+public:
+    // Bytes handed to GL per Pump(); one texture is always allowed through.
+    size_t uploadBudget = 8 * 1024 * 1024;
+
+    std::shared_ptr<Texture2D> Load(const std::string &path, Type type = Type::DIFFUSE, bool gamma = true)
+    {
+        auto texture = std::make_shared<Texture2D>(path, type, gamma, Texture2D::Deferred{});
+        std::weak_ptr<Texture2D> target = texture;
+
+        bool compress = Texture2D::CanCompress(gamma);
+        auto state = this->state;
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->inFlight++;
+        }
+
+        ThreadPool::Get().Submit([state, target, path, gamma, compress]()
+                                 {
+            Ready ready{};
+            ready.target = target;
+            try
+            {
+                // Skip the work if nobody holds the texture anymore
+                if (!target.expired())
+                    ready.data = compress ? TextureCompiler::LoadCompressed(path, gamma)
+                                          : TextureCompiler::Decode(path, gamma);
+            }
+            catch (const std::exception &e)
+            {
+                std::cout << "[TextureStreamer] " << e.what() << std::endl;
+            }
+
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->ready.push_back(std::move(ready));
+            state->inFlight--; });
+
+        return texture;
+    }
+
+    // Uploads decoded textures; call once per frame on the GL thread.
+    void Pump()
+    {
+        size_t spent = 0;
+        while (spent < uploadBudget)
+        {
+            Ready ready;
+            {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                if (state->ready.empty())
+                    break;
+                ready = std::move(state->ready.front());
+                state->ready.pop_front();
+            }
+
+            auto texture = ready.target.lock();
+            if (!texture || ready.data.levels.empty())
+                continue;
+
+            size_t bytes = ready.data.ByteSize();
+            UploadThroughPixelBuffer(*texture, ready.data, bytes);
+            spent += bytes;
+            uploadedBytes += bytes;
+            uploadedTextures++;
+        }
+    }
+
+    // Textures still decoding or waiting for upload.
+    size_t GetPendingCount() const
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        return state->inFlight + state->ready.size();
+    }
+
+    bool IsIdle() const { return GetPendingCount() == 0; }
+
+    size_t GetUploadedBytes() const { return uploadedBytes; }
+    size_t GetUploadedTextures() const { return uploadedTextures; }
+
+private:
+    struct Ready
+    {
+        std::weak_ptr<Texture2D> target;
+        TextureData data;
+    };
+
+    // Shared with decode jobs so they never outlive what they write into.
+    struct State
+    {
+        mutable std::mutex mutex;
+        std::deque<Ready> ready;
+        size_t inFlight = 0;
+    };
+
+    TextureStreamer() = default;
+    ~TextureStreamer()
+    {
+        if (pixelBuffer)
+            glDeleteBuffers(1, &pixelBuffer);
+    }
+
+    void UploadThroughPixelBuffer(Texture2D &texture, const TextureData &data, size_t bytes)
+    {
+        if (!pixelBuffer)
+            glGenBuffers(1, &pixelBuffer);
+
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixelBuffer);
+
+        // Orphan the previous storage so mapping never waits on an earlier upload.
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, bytes, nullptr, GL_STREAM_DRAW);
+        void *mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+
+        if (mapped)
+        {
+            uint8_t *dst = static_cast<uint8_t *>(mapped);
+            for (auto &level : data.levels)
+            {
+                std::memcpy(dst, level.data.data(), level.data.size());
+                dst += level.data.size();
+            }
+        }
+
+        if (mapped && glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER))
+        {
+            texture.Upload(data, true);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        }
+        else
+        {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            texture.Upload(data);
+        }
+    }
+
+    std::shared_ptr<State> state = std::make_shared<State>();
+    GLuint pixelBuffer = 0;
+
+    size_t uploadedBytes = 0;
+    size_t uploadedTextures = 0;
+};
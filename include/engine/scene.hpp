@@ -10,6 +10,7 @@
 #include <engine/systems/render.hpp>
 #include <engine/systems/update.hpp>
 #include <engine/systems/physics.hpp>
+#include <engine/tracer.hpp>
 
 class Scene : public std::enable_shared_from_this<Scene>
 {
@@ -41,8 +42,32 @@ public:
         return entity;
     }
 
+    // Adds already built hierarchies in one go, without per-entity logging.
+    void AddEntities(const std::vector<std::shared_ptr<Entity>> &roots)
+    {
+        entities.reserve(entities.size() + roots.size());
+        for (auto &root : roots)
+            entities.push_back(root);
+    }
+
+    // Root entities; children are reached through Entity::GetChildren().
+    const std::vector<std::shared_ptr<Entity>> &GetEntities() const { return entities; }
+
+    int GetWidth() const { return width; }
+    int GetHeight() const { return height; }
+
+    template <typename T>
+    std::shared_ptr<T> GetSystem() const
+    {
+        for (auto &s : systems)
+            if (auto casted = std::dynamic_pointer_cast<T>(s))
+                return casted;
+        return nullptr;
+    }
+
     void Begin()
     {
+        TRACE_SCOPE("Scene::Begin");
         PhysicsSystem::Get().OnAttach(entities);
         for (auto &s : systems)
         {
@@ -0,0 +1,186 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+
+class Scene;
+
+// .oscn: entity hierarchy plus one flat table per component type. Entities are
+// stored parents first and components refer to them by index, so loading is a
+// straight walk over each table.
+namespace SceneFormat
+{
+    constexpr char MAGIC[4] = {'O', 'S', 'C', 'N'};
+    constexpr uint32_t VERSION = 1;
+
+    enum Table : uint32_t
+    {
+        ASSETS,
+        MESHES,
+        CAMERAS,
+        LIGHTS,
+        BOX_COLLIDERS,
+        SPHERE_COLLIDERS,
+        CAPSULE_COLLIDERS,
+        MESH_COLLIDERS,
+        RIGIDBODIES,
+        LOOKERS,
+        OCCLUDERS,
+        CANVASES,
+        IMAGES,
+        TABLE_COUNT
+    };
+
+    struct TableRange
+    {
+        uint32_t count;
+        uint32_t stride; // record size, checked on load
+        uint64_t offset;
+    };
+
+    struct Header
+    {
+        char magic[4];
+        uint32_t version;
+        uint32_t entityCount;
+        uint32_t reserved;
+        uint64_t entitiesOffset;
+        uint64_t stringsOffset;
+        uint64_t stringsSize;
+        uint64_t fileSize;
+        TableRange tables[TABLE_COUNT];
+    };
+
+    struct Entity
+    {
+        int32_t parent; // always lower than the entity's own index
+        uint32_t nameOffset;
+        uint32_t nameLength;
+        float position[3];
+        float rotation[4]; // w, x, y, z
+        float scale[3];
+    };
+
+    // A model file; meshes refer to it by index.
+    struct Asset
+    {
+        uint32_t pathOffset;
+        uint32_t pathLength;
+        uint32_t residency;
+    };
+
+    enum MeshFlags : uint32_t
+    {
+        MESH_RENDERER = 1 << 0,
+        MESH_LIT = 1 << 1,
+        MESH_CAST_SHADOWS = 1 << 2,
+        MESH_RECEIVE_SHADOWS = 1 << 3
+    };
+
+    // MeshFilter, plus its MeshRenderer when MESH_RENDERER is set.
+    struct Mesh
+    {
+        uint32_t entity;
+        uint32_t asset;
+        uint32_t mesh; // index into the asset's meshes
+        uint32_t flags;
+    };
+
+    struct Camera
+    {
+        uint32_t entity;
+        float fov;
+        float nearPlane;
+        float farPlane;
+    };
+
+    struct Light
+    {
+        uint32_t entity;
+        uint32_t type;
+        float color[3];
+        float intensity;
+        float direction[3];
+        float range;
+    };
+
+    struct BoxCollider
+    {
+        uint32_t entity;
+        float halfSize[3];
+    };
+
+    struct SphereCollider
+    {
+        uint32_t entity;
+        float radius;
+    };
+
+    struct CapsuleCollider
+    {
+        uint32_t entity;
+        float radius;
+        float height;
+    };
+
+    enum RigidBodyFlags : uint32_t
+    {
+        BODY_GRAVITY = 1 << 0,
+        BODY_KINEMATIC = 1 << 1,
+        BODY_FREEZE_POSITION_X = 1 << 2, // Y, Z follow
+        BODY_FREEZE_ROTATION_X = 1 << 5, // Y, Z follow
+        BODY_NO_INTERPOLATION = 1 << 8
+    };
+
+    struct RigidBody
+    {
+        uint32_t entity;
+        float mass;
+        uint32_t flags;
+    };
+
+    struct Looker
+    {
+        uint32_t entity;
+        float sensitivity;
+        float speed;
+    };
+
+    // Components without data: mesh colliders, occluders and canvases.
+    struct Marker
+    {
+        uint32_t entity;
+    };
+
+    struct Image
+    {
+        uint32_t entity;
+        uint32_t pathOffset;
+        uint32_t pathLength;
+        float position[2];
+        float size[2];
+    };
+}
+
+// Saves and loads whole scenes as .oscn. Meshes are saved as references into
+// models loaded through ModelRegistry; components the format doesn't know about
+// (and runtime ones such as PhysicsComponent) are skipped.
+class SceneSerializer
+{
+public:
+    struct Stats
+    {
+        size_t entities = 0;
+        size_t components = 0;
+        size_t assets = 0;
+        size_t skipped = 0; // components not stored
+        size_t bytes = 0;
+        double milliseconds = 0.0;
+    };
+
+    // Writes every entity of scene to path. False when the file cannot be written.
+    static bool Save(const Scene &scene, const std::string &path, Stats *stats = nullptr);
+
+    // Adds the entities stored in path to scene; throws if the file is missing or invalid.
+    static Stats Load(const std::string &path, const std::shared_ptr<Scene> &scene);
+};
@@ -0,0 +1,294 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include <algorithm>
+#include <iostream>
+#include <functional>
+#include <unordered_map>
+
+#include <engine/singleton.hpp>
+#include <engine/threadpool.hpp>
+#include <engine/modelasset.hpp>
+#include <engine/modelimporter.hpp>
+#include <engine/scene.hpp>
+
+struct SceneLoadItem
+{
+    std::string path;
+    MeshResidency residency = MeshResidency::GpuOnly;
+
+    // Runs on the main thread once the whole load is attached to the scene.
+    std::function<void(const std::shared_ptr<Entity> &)> onLoaded;
+};
+
+// Handle to one background load. Polled from the main thread.
+class SceneLoad
+{
+    friend class SceneLoader;
+
+public:
+    enum class State
+    {
+        Importing, // reading and processing files on the workers
+        Uploading, // creating meshes, a budget per frame
+        Done,
+        Failed
+    };
+
+    State GetState() const { return state; }
+    bool IsFinished() const { return state == State::Done || state == State::Failed; }
+    const std::string &GetError() const { return error; }
+
+    // Import and mesh upload each count for half of an item. Textures keep
+    // streaming in after Done and are not included.
+    float GetProgress() const
+    {
+        if (state == State::Done)
+            return 1.0f;
+        if (items.empty())
+            return 0.0f;
+
+        float progress = 0.0f;
+        for (auto &item : items)
+        {
+            if (item.asset)
+                progress += 1.0f;
+            else if (item.staged)
+                progress += 0.5f + 0.5f * item.staged->GetUploadProgress();
+        }
+        return progress / (float)items.size();
+    }
+
+    // Model roots in request order, filled when the load is Done.
+    const std::vector<std::shared_ptr<Entity>> &GetRoots() const { return roots; }
+
+private:
+    // Worker output, shared by every load that asked for the same file.
+    struct ImportJob
+    {
+        std::mutex mutex;
+        bool done = false;
+        std::shared_ptr<const ModelFile> file;
+        std::string error;
+    };
+
+    struct Item
+    {
+        SceneLoadItem request;
+        std::shared_ptr<ImportJob> job;
+        std::shared_ptr<ModelAsset> staged;
+        std::shared_ptr<const ModelAsset> asset;
+    };
+
+    std::weak_ptr<Scene> scene;
+    std::vector<Item> items;
+    std::vector<std::shared_ptr<Entity>> roots;
+    State state = State::Importing;
+    std::string error;
+    std::chrono::steady_clock::time_point started;
+};
+
+// Loads models without stalling the main loop: file I/O and import run on the
+// thread pool, meshes are created a limited number of bytes per frame, and the
+// finished hierarchy is added to the scene in a single Pump() call.
+class SceneLoader : public Singleton<SceneLoader>
+{
+    friend class Singleton<SceneLoader>; // REQUIRED
+
+public:
+    // Geometry bytes handed to GL per Pump(), shared by all loads.
+    size_t uploadBudget = 8 * 1024 * 1024;
+
+    std::shared_ptr<SceneLoad> Load(const std::shared_ptr<Scene> &scene, std::vector<SceneLoadItem> requests)
+    {
+        auto load = std::make_shared<SceneLoad>();
+        load->scene = scene;
+        load->started = std::chrono::steady_clock::now();
+
+        load->items.reserve(requests.size());
+        for (auto &request : requests)
+        {
+            SceneLoad::Item item;
+            item.request = std::move(request);
+
+            // Already resident models skip the import entirely
+            item.asset = ModelRegistry::Get().Find(item.request.path, item.request.residency);
+            if (!item.asset)
+                item.job = Import(item.request.path);
+
+            load->items.push_back(std::move(item));
+        }
+
+        loads.push_back(load);
+        return load;
+    }
+
+    // Advances every load; call once per frame on the GL thread.
+    void Pump()
+    {
+        size_t spent = 0;
+        for (auto &load : loads)
+            Advance(*load, spent);
+
+        loads.erase(std::remove_if(loads.begin(), loads.end(),
+                                   [](const std::shared_ptr<SceneLoad> &load)
+                                   { return load->IsFinished(); }),
+                    loads.end());
+    }
+
+    // Drops every unfinished load; running imports finish and are discarded.
+    void CancelAll()
+    {
+        loads.clear();
+        staging.clear();
+    }
+
+    size_t GetPendingCount() const { return loads.size(); }
+    bool IsIdle() const { return loads.empty(); }
+
+private:
+    SceneLoader() = default;
+
+    std::shared_ptr<SceneLoad::ImportJob> Import(const std::string &path)
+    {
+        if (auto running = imports[path].lock())
+            return running;
+
+        auto job = std::make_shared<SceneLoad::ImportJob>();
+        imports[path] = job;
+
+        ThreadPool::Get().Submit([job, path]()
+                                 {
+            std::shared_ptr<const ModelFile> file;
+            std::string error;
+            try
+            {
+                TRACE_SCOPE("Model::Load", path);
+                file = ModelImporter::LoadCached(path);
+            }
+            catch (const std::exception &e)
+            {
+                error = e.what();
+            }
+
+            std::lock_guard<std::mutex> lock(job->mutex);
+            job->file = std::move(file);
+            job->error = std::move(error);
+            job->done = true; });
+
+        return job;
+    }
+
+    void Advance(SceneLoad &load, size_t &spent)
+    {
+        auto scene = load.scene.lock();
+        if (!scene)
+            return Fail(load, "scene was destroyed");
+
+        bool ready = true;
+        for (auto &item : load.items)
+        {
+            if (item.asset)
+                continue;
+
+            if (!item.staged && !Stage(load, item))
+            {
+                if (load.state == SceneLoad::State::Failed)
+                    return;
+                ready = false;
+                continue;
+            }
+
+            load.state = SceneLoad::State::Uploading;
+            if (spent < uploadBudget)
+                spent += item.staged->UploadMeshes(uploadBudget - spent);
+
+            if (!item.staged->IsComplete())
+            {
+                ready = false;
+                continue;
+            }
+
+            // The first load to finish a shared upload registers it
+            auto pending = staging.find(item.request.path);
+            if (pending != staging.end() && pending->second == item.staged)
+            {
+                ModelRegistry::Get().Insert(item.request.path, item.staged);
+                staging.erase(pending);
+            }
+            item.asset = std::move(item.staged);
+        }
+
+        if (ready)
+            Attach(load, scene);
+    }
+
+    // Creates the item's staged asset once its import finished. Returns false
+    // while it is still running or after failing the load.
+    bool Stage(SceneLoad &load, SceneLoad::Item &item)
+    {
+        const std::string &path = item.request.path;
+
+        // Another load may have finished or started uploading the same model
+        if ((item.asset = ModelRegistry::Get().Find(path, item.request.residency)))
+            return true;
+
+        auto pending = staging.find(path);
+        if (pending != staging.end() &&
+            (item.request.residency == MeshResidency::GpuOnly || pending->second->GetResidency() == MeshResidency::KeepCpu))
+        {
+            item.staged = pending->second;
+            return true;
+        }
+
+        std::shared_ptr<const ModelFile> file;
+        {
+            std::lock_guard<std::mutex> lock(item.job->mutex);
+            if (!item.job->done)
+                return false;
+            if (!item.job->file)
+            {
+                Fail(load, item.job->error);
+                return false;
+            }
+            file = item.job->file;
+        }
+        imports.erase(path);
+
+        item.staged = std::make_shared<ModelAsset>(file, ModelRegistry::Directory(path), item.request.residency, ModelAsset::Staged{});
+        staging[path] = item.staged;
+        return true;
+    }
+
+    void Attach(SceneLoad &load, const std::shared_ptr<Scene> &scene)
+    {
+        for (auto &item : load.items)
+            load.roots.push_back(item.asset->Instantiate(scene));
+
+        for (auto &root : load.roots)
+            scene->AddEntity(root);
+
+        for (size_t i = 0; i < load.items.size(); i++)
+            if (load.items[i].request.onLoaded)
+                load.items[i].request.onLoaded(load.roots[i]);
+
+        load.state = SceneLoad::State::Done;
+
+        float ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - load.started).count();
+        std::cout << "[SceneLoader] Loaded " << load.items.size() << " model(s) in " << ms << " ms" << std::endl;
+    }
+
+    void Fail(SceneLoad &load, const std::string &error)
+    {
+        load.state = SceneLoad::State::Failed;
+        load.error = error;
+        std::cout << "[SceneLoader] Load failed: " << error << std::endl;
+    }
+
+    std::vector<std::shared_ptr<SceneLoad>> loads;
+    std::unordered_map<std::string, std::weak_ptr<SceneLoad::ImportJob>> imports;
+    std::unordered_map<std::string, std::shared_ptr<ModelAsset>> staging;
+};
@@ -2,29 +2,51 @@
 
 #include <string>
 #include <unordered_map>
+#include <vector>
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
 class Shader
 {
 public:
+    struct Source
+    {
+        std::string vertex;
+        std::string fragment;
+    };
+
     Shader(const std::string& filepath);
     Shader(const std::string& vertexPath, const std::string& fragmentPath);
+    explicit Shader(const Source& source);
     ~Shader();
 
+    Shader(const Shader&) = delete;
+    Shader& operator=(const Shader&) = delete;
+
+    // Splits a combined file on its "#shader vertex" / "#shader fragment" lines.
+    static Source ReadSource(const std::string& filepath);
+    static std::string ReadFile(const std::string& filepath);
+
+    // Reads filepath with each #include "file" (relative to the including file)
+    // replaced by its contents, every file at most once.
+    static std::string ReadWithIncludes(const std::string& filepath);
+
+    // Returns source with "#define <entry>" lines added after each stage's #version.
+    static Source WithDefines(const Source& source, const std::vector<std::string>& defines);
+
     void Use() const;
 
     template<typename T>
     void SetUniform(const std::string& name, const T& value) const;
 
 private:
+    void Build(const Source& source);
     unsigned int Compile(GLenum type, const std::string& source);
     void LinkProgram();
 
     void CheckShaderCompile(unsigned int shader, const std::string& type);
     void CheckProgramLink(unsigned int program);
 
-    std::string ReadFile(const std::string& filepath);
     unsigned int GetUniformLocation(const std::string& name) const;
 
 private:
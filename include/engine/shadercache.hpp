@@ -0,0 +1,49 @@
+#pragma once
+#include <engine/singleton.hpp>
+#include <engine/shader.hpp>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+// Shares one Shader per distinct source and keeps linked program binaries on disk
+// under ASSET_CACHE_DIR/shaders. A binary is only reused when the source hash and
+// the driver (vendor, renderer, version) match; anything else recompiles.
+class ShaderCache : public Singleton<ShaderCache>
+{
+    friend class Singleton<ShaderCache>; // REQUIRED
+
+public:
+    struct Stats
+    {
+        size_t memoryHits = 0;
+        size_t binaryHits = 0;
+        size_t compiles = 0;
+    };
+
+    bool binaryCache = true;
+
+    std::shared_ptr<Shader> Load(const std::string &filepath);
+    std::shared_ptr<Shader> Load(const Shader::Source &source);
+
+    static uint64_t Hash(const Shader::Source &source);
+
+    // Used by Shader while building its program.
+    bool LoadBinary(uint64_t hash, unsigned int program);
+    void PrepareBinary(unsigned int program);
+    void OnCompiled(uint64_t hash, unsigned int program);
+
+    const Stats &GetStats() const { return stats; }
+
+private:
+    ShaderCache() = default;
+
+    bool UseBinaries();
+    const std::string &DriverString();
+    std::string BinaryPath(uint64_t hash) const;
+
+    std::unordered_map<uint64_t, std::weak_ptr<Shader>> programs;
+    std::string driver;
+    int binarySupport = -1; // unknown until the first program is built
+    Stats stats;
+};
@@ -7,11 +7,13 @@
 #include <engine/components/physics/collider/spherecollider3d.hpp>
 #include <engine/components/physics/collider/capsulecollider3d.hpp>
 #include <engine/components/physics/collider/meshcollider3d.hpp>
+#include <engine/components/physics/motionstate.hpp>
 #include <engine/singleton.hpp>
 
 #include <Bullet3/btBulletDynamicsCommon.h>
 #include <vector>
 #include <memory>
+#include <unordered_set>
 
 class PhysicsSystem : public Singleton<PhysicsSystem>, public System
 {
@@ -19,8 +21,9 @@ class PhysicsSystem : public Singleton<PhysicsSystem>, public System
 
 public:
     glm::vec3 gravity{0.0f, -9.81f, 0.0f};
-    float fixedDeltaTime = 1.0f / 60.0f;
-    float accumulator = 0.0f;
+    float fixedDeltaTime = 1.0f / 60.0f; // 1/30 is enough for servers and low-end clients
+    int maxSubSteps = 4; // steps per frame before simulation time is dropped
+    float accumulator = 0.0f; // time since the last step, mirrors Bullet's own
 
 private:
     btBroadphaseInterface* broadphase = nullptr;
@@ -29,7 +32,10 @@ private:
     btSequentialImpulseConstraintSolver* solver = nullptr;
     btDiscreteDynamicsWorld* world = nullptr;
 
-    std::vector<btCollisionShape*> ownedShapes;
+    // Entities that gained a collider or rigid body since the last update
+    std::vector<std::weak_ptr<Entity>> pending;
+    // Motion states Bullet updated during the current step call
+    std::vector<EntityMotionState*> moved;
 
 private:
     PhysicsSystem() : System("PhysicsSystem") {}
@@ -47,24 +53,24 @@ public:
         world = new btDiscreteDynamicsWorld(dispatcher, broadphase, solver, collisionConfig);
 
         world->setGravity(btVector3(gravity.x, gravity.y, gravity.z));
+        world->setInternalTickCallback(OnStep);
     }
 
     void Clean() override
     {
         if (!world) return;
 
-        // Remove all rigid bodies
+        // Bodies of entities that outlive the world are freed through their component
         for (int i = world->getNumCollisionObjects() - 1; i >= 0; --i)
         {
             btCollisionObject* obj = world->getCollisionObjectArray()[i];
-            btRigidBody* body = btRigidBody::upcast(obj);
-            if (body && body->getMotionState()) delete body->getMotionState();
-            world->removeCollisionObject(obj);
-            delete obj;
+            if (auto* phys = static_cast<PhysicsComponent*>(obj->getUserPointer()))
+                phys->Release();
+            else
+                world->removeCollisionObject(obj);
         }
-
-        for (auto* shape : ownedShapes) delete shape;
-        ownedShapes.clear();
+        pending.clear();
+        moved.clear();
 
         delete world;
         delete solver;
@@ -75,39 +81,75 @@ public:
         world = nullptr;
     }
 
+    /* =========================
+       Body Registration
+       ========================= */
+    // Called by Collider and RigidBody3D when attached, at any depth of the
+    // hierarchy. Bodies are built once per frame, so steps do no lookups.
+    void Enqueue(const std::shared_ptr<Entity>& entity)
+    {
+        pending.push_back(entity);
+    }
+
     /* =========================
        Update Loop
        ========================= */
-    void Update(std::vector<std::shared_ptr<Entity>>& entities, float dt) override
+    void Update(std::vector<std::shared_ptr<Entity>>& /*entities*/, float dt) override
     {
+        if (!world) return;
+
+        if (!pending.empty())
+            RegisterPending();
+
+        // Bullet runs the fixed substeps itself and reports active bodies to
+        // their EntityMotionState; entities are written once, after the last one
         accumulator += dt;
+        int steps = world->stepSimulation(dt, maxSubSteps, fixedDeltaTime);
+        accumulator -= steps * fixedDeltaTime; // steps over maxSubSteps are dropped too
 
-        while (accumulator >= fixedDeltaTime)
-        {
-            RegisterNewBodies(entities);
-            world->stepSimulation(fixedDeltaTime);
-            SyncTransforms(entities);
-            accumulator -= fixedDeltaTime;
-        }
+        float alpha = glm::clamp(accumulator / fixedDeltaTime, 0.0f, 1.0f);
+        for (auto* state : moved)
+            state->Apply(alpha);
+        moved.clear();
     }
 
 private:
     /* =========================
        Body Creation
        ========================= */
-    void RegisterNewBodies(std::vector<std::shared_ptr<Entity>>& entities)
+    // Runs after every fixed step; keeps the last two transforms of moving bodies
+    static void OnStep(btDynamicsWorld* world, btScalar)
     {
-        for (auto& entity : entities)
+        auto& bodies = static_cast<btDiscreteDynamicsWorld*>(world)->getNonStaticRigidBodies();
+        for (int i = 0; i < bodies.size(); ++i)
         {
-            auto phys = entity->GetComponent<PhysicsComponent>();
-            if (!phys) phys = entity->AddComponent<PhysicsComponent>();
-            if (phys->body) continue;
+            btRigidBody* body = bodies[i];
+            if (body->isKinematicObject() || !body->isActive()) continue;
+            static_cast<EntityMotionState*>(body->getMotionState())->Step(body->getWorldTransform());
+        }
+    }
+
+    void RegisterPending()
+    {
+        std::vector<std::weak_ptr<Entity>> queued;
+        queued.swap(pending);
 
+        // An entity is queued once per component, build its body once
+        std::unordered_set<const Entity*> built;
+        for (auto& weak : queued)
+        {
+            auto entity = weak.lock();
+            if (!entity || !built.insert(entity.get()).second) continue;
+
+            // A rigid body waits for its collider
             auto collider = entity->GetComponent<Collider>();
             if (!collider) continue;
 
-            auto rigidbody = entity->GetComponent<RigidBody3D>();
-            CreateRigidBody(entity, phys, collider, rigidbody);
+            auto phys = entity->GetComponent<PhysicsComponent>();
+            if (!phys) phys = entity->AddComponent<PhysicsComponent>();
+            phys->Release(); // rebuilt when a rigid body joins a collider
+
+            CreateRigidBody(entity, phys, collider, entity->GetComponent<RigidBody3D>());
         }
     }
 
@@ -121,24 +163,18 @@ private:
 
         // Create collision shape dynamically
         btCollisionShape* shape = collider->CreateShape();
-        ownedShapes.push_back(shape);
-
-        // Initial transform
-        btTransform startTransform;
-        startTransform.setIdentity();
-        startTransform.setOrigin(btVector3(
-            entity->transform.position.x,
-            entity->transform.position.y,
-            entity->transform.position.z));
+        if (!shape) return;
 
         // Calculate inertia
         btVector3 inertia(0, 0, 0);
         if (mass > 0.0f) shape->calculateLocalInertia(mass, inertia);
 
-        // Rigid body creation
-        btDefaultMotionState* motionState = new btDefaultMotionState(startTransform);
+        // Rigid body creation, starting from the entity's world transform
+        bool interpolate = rigidbody && rigidbody->interpolation == RigidbodyInterpolation::Interpolate;
+        EntityMotionState* motionState = new EntityMotionState(entity, moved, interpolate);
         btRigidBody::btRigidBodyConstructionInfo rbInfo(mass, motionState, shape, inertia);
         btRigidBody* body = new btRigidBody(rbInfo);
+        body->setUserPointer(phys.get());
 
         // Kinematic and gravity settings
         if (rigidbody)
@@ -156,26 +192,6 @@ private:
         // Store references
         phys->body = body;
         phys->shape = shape;
-    }
-
-    /* =========================
-       Sync Physics → ECS
-       ========================= */
-    void SyncTransforms(std::vector<std::shared_ptr<Entity>>& entities)
-    {
-        for (auto& entity : entities)
-        {
-            auto phys = entity->GetComponent<PhysicsComponent>();
-            if (!phys || !phys->body) continue;
-
-            btTransform trans;
-            phys->body->getMotionState()->getWorldTransform(trans);
-
-            const btVector3& pos = trans.getOrigin();
-            const btQuaternion& rot = trans.getRotation();
-
-            entity->transform.position = { pos.x(), pos.y(), pos.z() };
-            entity->transform.rotation = glm::quat(rot.w(), rot.x(), rot.y(), rot.z());
-        }
+        phys->world = world;
     }
 };
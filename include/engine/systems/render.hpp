@@ -1,27 +1,42 @@
 #pragma once
 #include <engine/ecs/system.hpp>
-#include <engine/shader.hpp>
+#include <algorithm>
+#include <engine/shadercache.hpp>
 #include <engine/components/meshrenderer.hpp>
 #include <engine/components/camera.hpp>
 #include <engine/components/light.hpp>
+#include <engine/components/occluder.hpp>
 
 #include <engine/buffers/quad.hpp>
 #include <engine/buffers/fbo.hpp>
 #include <engine/buffers/sbo.hpp>
 
+#include <engine/render/occlusion.hpp>
+#include <engine/render/dynamicresolution.hpp>
+#include <engine/render/batcher.hpp>
+#include <engine/render/meshlet.hpp>
+#include <engine/render/shadervariants.hpp>
+
 #include <engine/components/ui/canvas.hpp>
 #include <engine/input.hpp>
 
+enum class AntiAliasingMode
+{
+    None, // single sample, no post pass
+    MSAA, // multisampled scene FBO resolved into ifbo
+    FXAA  // single sample with an FXAA pass in the final quad
+};
+
 class RenderSystem : public System
 {
 public:
     RenderSystem(int width, int height) : System("RenderSystem"), width(width), height(height)
     {
-        defaultShader = std::make_shared<Shader>("assets/shaders/scene.glsl");
-        bufferShader = std::make_shared<Shader>("assets/shaders/screen.glsl");
-        depthShader = std::make_shared<Shader>("assets/shaders/depth.glsl");
+        sceneShaders = std::make_unique<ShaderVariants>("assets/shaders/scene.glsl");
+        bufferShader = ShaderCache::Get().Load("assets/shaders/screen.glsl");
+        depthShader = ShaderCache::Get().Load("assets/shaders/depth.glsl");
 
-        fbo = std::make_shared<FBO>(width, height, 8);
+        fbo = std::make_shared<FBO>(width, height, msaaSamples);
         ifbo = std::make_shared<FBO>(width, height, 1);
         sbo = std::make_shared<SBO>(2048);
 
@@ -29,6 +44,7 @@ public:
 
         bufferShader->Use();
         bufferShader->SetUniform("screenTexture", 0);
+        bufferShader->SetUniform("uvScale", glm::vec2(1.0f));
 
         glEnable(GL_CULL_FACE);
         glFrontFace(GL_CCW);
@@ -41,6 +57,10 @@ public:
 
         for (auto &entity : entities)
             CollectLights(entity, frameLights);
+
+        // The scene shader walks lights grouped by type instead of branching per light.
+        std::stable_sort(frameLights.begin(), frameLights.end(), [](const auto &a, const auto &b)
+                         { return (int)a->type < (int)b->type; });
     }
 
     void Render(std::vector<std::shared_ptr<Entity>> &entities) override
@@ -58,6 +78,14 @@ public:
         glm::mat4 lightProj = glm::ortho(-10.f, 10.f, -10.f, 10.f, 0.1f, 50.f);
         glm::mat4 lightVP = lightProj * lightView;
 
+        GeometryAllocator::Get().Maintain();
+
+        if (dynamicResolution)
+        {
+            dynamicResolution->BeginFrame();
+            ApplyRenderScale(dynamicResolution->GetScale());
+        }
+
         RenderShadowMap(entities, lightVP);
         RenderScene(entities, lightVP);
         RenderFinalQuad();
@@ -74,6 +102,9 @@ public:
         glDisable(GL_BLEND); // Disable blending after UI rendering
         // --- End UI Rendering ---
 
+        if (dynamicResolution)
+            dynamicResolution->EndFrame();
+
 
 
     }
@@ -89,30 +120,113 @@ public:
         }
     }
 
+    const OcclusionCuller::Stats &GetOcclusionStats() const { return occlusion.GetStats(); }
+    const MeshletCuller::Stats &GetMeshletStats() const { return meshlets.GetStats(); }
+
+    // Renders the scene into a scaled viewport of an FBO sized for maxScale, so
+    // changing the scale never reallocates; the final quad upscales to the window.
+    void SetDynamicResolution(bool enabled, float targetFrameMs = 16.0f, float minScale = 0.5f, float maxScale = 1.0f)
+    {
+        if (!enabled)
+        {
+            dynamicResolution.reset();
+            maxRenderScale = 1.0f;
+            ResizeTargets();
+            return;
+        }
+
+        if (!dynamicResolution)
+            dynamicResolution = std::make_unique<DynamicResolution>();
+
+        dynamicResolution->targetFrameMs = targetFrameMs;
+        dynamicResolution->minScale = minScale;
+        dynamicResolution->maxScale = maxScale;
+        dynamicResolution->Reset();
+
+        maxRenderScale = maxScale;
+        ResizeTargets();
+    }
+
+    float GetRenderScale() const { return renderScale; }
+
+    // Switches the anti-aliasing mode at runtime, reallocating the scene FBO when the
+    // sample count changes. samples is only used by MSAA and is rounded to 2/4/8.
+    void SetAntiAliasing(AntiAliasingMode mode, int samples = 8)
+    {
+        int count = 1;
+        if (mode == AntiAliasingMode::MSAA)
+        {
+            GLint maxSamples = 1;
+            glGetIntegerv(GL_MAX_SAMPLES, &maxSamples);
+
+            count = samples >= 8 ? 8 : samples >= 4 ? 4 : samples >= 2 ? 2 : 1;
+            while (count > maxSamples)
+                count /= 2;
+        }
+
+        if (mode == AntiAliasingMode::FXAA && !fxaaShader)
+        {
+            fxaaShader = ShaderCache::Get().Load("assets/shaders/fxaa.glsl");
+            fxaaShader->Use();
+            fxaaShader->SetUniform("screenTexture", 0);
+        }
+
+        antiAliasing = count > 1 ? mode : (mode == AntiAliasingMode::FXAA ? mode : AntiAliasingMode::None);
+        if (count == msaaSamples)
+            return;
+
+        msaaSamples = count;
+        if (msaaSamples > 1)
+            fbo = std::make_shared<FBO>(ifbo->GetWidth(), ifbo->GetHeight(), msaaSamples);
+        else
+            fbo.reset(); // render straight into ifbo
+        ApplyRenderScale(renderScale);
+    }
+
+    AntiAliasingMode GetAntiAliasing() const { return antiAliasing; }
+    int GetMSAASamples() const { return msaaSamples; }
+
     void OnResize(int w, int h, std::vector<std::shared_ptr<Entity>> &entities) override
     {
         width = w;
         height = h;
+        ResizeTargets();
 
         for (auto &entity : entities)
             if (auto camera = entity->GetComponent<Camera>())
                 camera->OnResize(w, h);
     }
 
+public:
+    bool occlusionCulling = true;
+    bool meshletCulling = true;
+
 private:
     float gamma = 1.1f;
     int width, height;
 
-    std::shared_ptr<Shader> defaultShader;
+    std::unique_ptr<ShaderVariants> sceneShaders;
     std::shared_ptr<Shader> bufferShader;
     std::shared_ptr<Shader> depthShader;
+    std::shared_ptr<Shader> fxaaShader;
 
-    std::shared_ptr<FBO> fbo;
+    std::shared_ptr<FBO> fbo; // multisampled scene target, null when rendering single sampled
     std::shared_ptr<FBO> ifbo;
     std::shared_ptr<SBO> sbo;
     std::shared_ptr<Quad> screen;
 
     std::vector<std::shared_ptr<Light>> frameLights;
+    OcclusionCuller occlusion{256, 128};
+    MeshletCuller meshlets;
+    DrawBatcher batcher;
+    std::vector<IndexRange> ranges;
+
+    std::unique_ptr<DynamicResolution> dynamicResolution;
+    float renderScale = 1.0f;
+    float maxRenderScale = 1.0f;
+
+    AntiAliasingMode antiAliasing = AntiAliasingMode::MSAA;
+    int msaaSamples = 8;
 
     // ------------------------
     // LIGHT COLLECTION
@@ -140,7 +254,13 @@ private:
         depthShader->Use();
         depthShader->SetUniform("lightViewProjection", lightVP);
 
-        DrawEntities(entities, *depthShader);
+        static std::vector<DrawItem> draws;
+        GatherDraws(entities, nullptr, nullptr, true, draws);
+
+        batcher.Begin();
+        for (auto &draw : draws)
+            batcher.Add(draw.mesh, draw.model, draw.firstIndex, draw.indexCount);
+        batcher.Flush(*depthShader, false);
 
         sbo->Unbind();
     }
@@ -150,43 +270,70 @@ private:
     // ------------------------
     void RenderScene(const std::vector<std::shared_ptr<Entity>> &entities, const glm::mat4 &lightVP)
     {
-        fbo->Bind();
+        FBO &target = fbo ? *fbo : *ifbo;
+        target.Bind();
         ClearBuffer();
 
         glEnable(GL_DEPTH_TEST);
         glEnable(GL_CULL_FACE);
         glCullFace(GL_BACK);
 
-        fbo->BindLayer(0);
-        defaultShader->Use();
-        defaultShader->SetUniform("lightViewProjection", lightVP);
+        target.BindLayer(0);
 
-        int lightIndex = 0;
-        for (auto &light : frameLights)
+        std::shared_ptr<Camera> mainCamera;
+        for (auto &entity : entities)
+            if (auto camera = entity->GetComponent<Camera>())
+                mainCamera = camera;
+
+        OcclusionCuller *culler = nullptr;
+        if (occlusionCulling && mainCamera)
         {
-            std::string prefix = "lights[" + std::to_string(lightIndex) + "]";
-            defaultShader->SetUniform(prefix + ".type", (int)light->type);
-            defaultShader->SetUniform(prefix + ".direction", light->direction);
-            defaultShader->SetUniform(prefix + ".position", light->entity.lock()->transform.position);
-            defaultShader->SetUniform(prefix + ".color", light->color);
-            defaultShader->SetUniform(prefix + ".intensity", light->intensity);
-            defaultShader->SetUniform(prefix + ".range", light->range);
-            lightIndex++;
+            PrepareOcclusion(entities, mainCamera->GetProjection() * mainCamera->GetView());
+            culler = &occlusion;
+        }
+
+        // The light sees other sides of a mesh, so only this pass culls meshlets
+        MeshletCuller *clusters = nullptr;
+        if (meshletCulling && mainCamera)
+        {
+            glm::mat4 view = mainCamera->GetView();
+            meshlets.Begin(mainCamera->GetProjection() * view, glm::vec3(glm::inverse(view)[3]));
+            clusters = &meshlets;
         }
-        defaultShader->SetUniform("lightCount", lightIndex);
 
         glActiveTexture(GL_TEXTURE1);
         glBindTexture(GL_TEXTURE_2D, sbo->GetDepthMap());
-        defaultShader->SetUniform("shadowMap", 1);
 
-        // Update camera matrices
-        for (auto &entity : entities)
-            if (auto camera = entity->GetComponent<Camera>())
-                camera->SetUniform(*defaultShader);
+        // Each draw gets the cheapest variant that covers it; variants then draw in runs.
+        static std::vector<DrawItem> draws;
+        GatherDraws(entities, culler, clusters, false, draws);
+
+        uint32_t lightBucket = ShaderVariants::LightBucket(frameLights.size());
+        for (auto &draw : draws)
+            draw.variant = SelectVariant(*draw.renderer, *draw.mesh, lightBucket);
+
+        std::sort(draws.begin(), draws.end(), [](const DrawItem &a, const DrawItem &b)
+                  { return a.variant.Packed() < b.variant.Packed(); });
+
+        for (size_t first = 0; first < draws.size();)
+        {
+            size_t last = first;
+            while (last < draws.size() && draws[last].variant == draws[first].variant)
+                last++;
+
+            Shader &shader = sceneShaders->Get(draws[first].variant);
+            ApplySceneUniforms(shader, lightVP, mainCamera);
 
-        DrawEntities(entities, *defaultShader);
+            batcher.Begin();
+            for (size_t i = first; i < last; ++i)
+                batcher.Add(draws[i].mesh, draws[i].model, draws[i].firstIndex, draws[i].indexCount);
+            batcher.Flush(shader, true);
 
-        fbo->BlitTo(*ifbo);
+            first = last;
+        }
+
+        if (fbo)
+            fbo->BlitTo(*ifbo);
         FBO::Unbind(width, height);
     }
 
@@ -200,12 +347,47 @@ private:
         glDisable(GL_DEPTH_TEST);
         glDisable(GL_CULL_FACE);
 
-        bufferShader->Use();
+        Shader &shader = antiAliasing == AntiAliasingMode::FXAA ? *fxaaShader : *bufferShader;
+        shader.Use();
+        shader.SetUniform("uvScale", glm::vec2(
+            (float)ifbo->GetViewportWidth() / (float)ifbo->GetWidth(),
+            (float)ifbo->GetViewportHeight() / (float)ifbo->GetHeight()));
+        if (antiAliasing == AntiAliasingMode::FXAA)
+            shader.SetUniform("texelSize", glm::vec2(1.0f / ifbo->GetWidth(), 1.0f / ifbo->GetHeight()));
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_2D, ifbo->GetColorTexture(0));
         screen->Draw();
     }
 
+    // ------------------------
+    // RENDER TARGETS
+    // ------------------------
+    void ResizeTargets()
+    {
+        int w = std::max(1, (int)std::ceil(width * maxRenderScale));
+        int h = std::max(1, (int)std::ceil(height * maxRenderScale));
+        if (fbo)
+            fbo->Resize(w, h);
+        ifbo->Resize(w, h);
+        ApplyRenderScale(renderScale);
+    }
+
+    void ApplyRenderScale(float scale)
+    {
+        renderScale = scale;
+
+        int w = width, h = height;
+        if (dynamicResolution)
+        {
+            // Snap to 8 pixels so small controller adjustments don't touch the viewport every frame.
+            w = std::max(8, (int)std::lround(width * scale / 8.0f) * 8);
+            h = std::max(8, (int)std::lround(height * scale / 8.0f) * 8);
+        }
+        if (fbo)
+            fbo->SetViewport(w, h);
+        ifbo->SetViewport(w, h);
+    }
+
     void ClearBuffer()
     {
         float val = pow(0.1f, gamma);
@@ -213,7 +395,49 @@ private:
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     }
 
-    void DrawEntities(const std::vector<std::shared_ptr<Entity>> &entities, Shader &shader)
+    // ------------------------
+    // OCCLUSION PASS
+    // ------------------------
+    void PrepareOcclusion(const std::vector<std::shared_ptr<Entity>> &entities, const glm::mat4 &viewProjection)
+    {
+        occlusion.Begin(viewProjection);
+
+        for (auto &entity : entities)
+            CollectOccluders(entity);
+
+        occlusion.Rasterize();
+    }
+
+    void CollectOccluders(const std::shared_ptr<Entity> &entity)
+    {
+        if (auto occluder = entity->GetComponent<Occluder>())
+        {
+            for (auto &shape : occluder->shapes)
+                if (auto owner = shape.owner.lock())
+                    occlusion.AddOccluder(
+                        owner->WorldMatrix(),
+                        shape.geometry->positions.data(),
+                        shape.geometry->positions.size(),
+                        shape.geometry->indices.data(),
+                        shape.geometry->indices.size());
+        }
+
+        for (auto &child : entity->GetChildren())
+            CollectOccluders(child);
+    }
+
+    struct DrawItem
+    {
+        MeshRenderer *renderer;
+        Mesh *mesh;
+        glm::mat4 model;
+        uint32_t firstIndex;
+        uint32_t indexCount;
+        ShaderVariantKey variant;
+    };
+
+    void GatherDraws(const std::vector<std::shared_ptr<Entity>> &entities, OcclusionCuller *culler, MeshletCuller *clusters,
+                     bool shadowCasters, std::vector<DrawItem> &out)
     {
         static std::vector<std::shared_ptr<MeshRenderer>> renderers;
         renderers.clear();
@@ -222,8 +446,96 @@ private:
         for (auto &entity : entities)
             CollectRenderers(entity, renderers);
 
+        out.clear();
         for (auto &render : renderers)
-            render->Render(shader);
+        {
+            if (shadowCasters && !render->castShadows)
+                continue;
+            if (culler && !IsVisible(*culler, render))
+                continue;
+
+            auto en = render->entity.lock();
+            auto filter = en ? en->GetComponent<MeshFilter>() : nullptr;
+            if (!filter || !filter->mesh)
+                continue;
+
+            Mesh *mesh = filter->mesh.get();
+            glm::mat4 model = en->WorldMatrix();
+            if (!clusters || mesh->GetMeshlets().empty())
+            {
+                out.push_back({render.get(), mesh, model, 0, mesh->GetIndexCount(), {}});
+                continue;
+            }
+
+            // One draw per run of visible meshlets; none when all of them are culled
+            ranges.clear();
+            clusters->Cull(mesh->GetMeshlets(), model, ranges);
+            for (auto &range : ranges)
+                out.push_back({render.get(), mesh, model, range.firstIndex, range.indexCount, {}});
+        }
+    }
+
+    ShaderVariantKey SelectVariant(const MeshRenderer &renderer, const Mesh &mesh, uint32_t lightBucket) const
+    {
+        ShaderVariantKey key;
+        if (!renderer.lit)
+        {
+            // Unlit variants ignore lights; share one regardless of the bucket
+            key.features = SHADER_UNLIT;
+            key.maxLights = 4;
+            return key;
+        }
+
+        key.maxLights = lightBucket;
+        if (renderer.receiveShadows)
+            key.features |= SHADER_SHADOWS;
+        if (mesh.HasTexture(Type::SPECULAR))
+            key.features |= SHADER_SPECULAR_MAP;
+        return key;
+    }
+
+    void ApplySceneUniforms(Shader &shader, const glm::mat4 &lightVP, const std::shared_ptr<Camera> &camera)
+    {
+        shader.Use();
+        shader.SetUniform("lightViewProjection", lightVP);
+
+        int counts[3] = {0, 0, 0};
+        int lightIndex = 0;
+        for (auto &light : frameLights)
+        {
+            if (lightIndex == 16)
+                break;
+
+            std::string prefix = "lights[" + std::to_string(lightIndex) + "]";
+            shader.SetUniform(prefix + ".type", (int)light->type);
+            shader.SetUniform(prefix + ".direction", light->direction);
+            shader.SetUniform(prefix + ".position", light->entity.lock()->transform.position);
+            shader.SetUniform(prefix + ".color", light->color);
+            shader.SetUniform(prefix + ".intensity", light->intensity);
+            shader.SetUniform(prefix + ".range", light->range);
+            counts[(int)light->type]++;
+            lightIndex++;
+        }
+        shader.SetUniform("directionalCount", counts[0]);
+        shader.SetUniform("pointCount", counts[1]);
+        shader.SetUniform("spotCount", counts[2]);
+        shader.SetUniform("shadowMap", 1);
+
+        if (camera)
+            camera->SetUniform(shader);
+    }
+
+    bool IsVisible(OcclusionCuller &culler, const std::shared_ptr<MeshRenderer> &render)
+    {
+        auto en = render->entity.lock();
+        if (!en)
+            return false;
+
+        auto filter = en->GetComponent<MeshFilter>();
+        if (!filter || !filter->mesh)
+            return true;
+
+        return culler.IsVisible(filter->mesh->GetBounds(), en->WorldMatrix());
     }
 
     void CollectRenderers(const std::shared_ptr<Entity> &entity, std::vector<std::shared_ptr<MeshRenderer>> &outRenderers)
@@ -1,8 +1,10 @@
 #pragma once
-#include <stb/stb_image.h>
 #include <string>
 #include <stdexcept>
 #include <glad/glad.h>
+#include <engine/glext.hpp>
+#include <engine/render/texturecompiler.hpp>
+#include <engine/tracer.hpp>
 
 enum struct Type
 {
@@ -14,8 +16,8 @@ enum struct Type
 class Texture2D
 {
 public:
-    unsigned int ID;
-    int width, height, channels;
+    unsigned int ID = 0;
+    int width = 0, height = 0, channels = 0;
     bool gamma;
     Type type;
     std::string path;
@@ -29,74 +31,149 @@ public:
         LoadFromFile(path);
     }
 
+    // Streamed textures start without storage and draw with the placeholder
+    // until TextureStreamer uploads them.
+    struct Deferred
+    {
+    };
+
+    Texture2D(const std::string &path, const Type &type, bool gamma, Deferred)
+    {
+        this->type = type;
+        this->path = path;
+        this->gamma = gamma;
+    }
+
     ~Texture2D()
     {
-        glDeleteTextures(1, &ID);
+        if (ID)
+            glDeleteTextures(1, &ID);
     }
 
     void Bind(unsigned int unit = 0) const
     {
         glActiveTexture(GL_TEXTURE0 + unit);
-        glBindTexture(GL_TEXTURE_2D, ID);
+        glBindTexture(GL_TEXTURE_2D, ID ? ID : Placeholder());
     }
 
-private:
-    void LoadFromFile(const std::string &path)
+    bool IsResident() const { return ID != 0; }
+
+    // Block-compressed uploads need S3TC (and its sRGB variant for gamma textures).
+    static bool CanCompress(bool gamma)
     {
-        stbi_set_flip_vertically_on_load(true);
+        return gamma ? GLExt::textureCompressionS3TCsRGB : GLExt::textureCompressionS3TC;
+    }
 
-        unsigned char *data = stbi_load(
-            path.c_str(),
-            &width,
-            &height,
-            &channels,
-            0);
+    // With fromPixelBuffer the level data has been copied back to back into the
+    // bound GL_PIXEL_UNPACK_BUFFER, so each level is sourced by its byte offset.
+    void Upload(const TextureData &data, bool fromPixelBuffer = false)
+    {
+        TRACE_SCOPE("Texture upload", path);
+        if (ID)
+            glDeleteTextures(1, &ID);
 
-        if (!data)
-        {
-            throw std::runtime_error("Failed to load texture: " + path);
-        }
+        width = data.width;
+        height = data.height;
+        channels = data.channels;
 
-        GLenum internalFormat = GL_RGB;
-        GLenum dataFormat = GL_RGB;
+        glGenTextures(1, &ID);
+        glBindTexture(GL_TEXTURE_2D, ID);
 
-        if (channels == 1)
+        size_t offset = 0;
+        auto source = [&](const TextureLevel &level) -> const void *
         {
-            internalFormat = dataFormat = GL_RED;
-        }
-        else if (channels == 3)
+            const void *ptr = fromPixelBuffer ? (const void *)offset : (const void *)level.data.data();
+            offset += level.data.size();
+            return ptr;
+        };
+
+        if (data.codec == TextureCodec::None)
         {
-            dataFormat = GL_RGB;
-            internalFormat = gamma ? GL_SRGB : GL_RGB;
+            const TextureLevel &level = data.levels[0];
+            GLenum dataFormat = channels == 1 ? GL_RED : GL_RGBA;
+            GLenum internalFormat = GL_RED;
+            if (channels == 3)
+                internalFormat = gamma ? GL_SRGB8 : GL_RGB8;
+            else if (channels != 1)
+                internalFormat = gamma ? GL_SRGB8_ALPHA8 : GL_RGBA8;
+
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            glTexImage2D(
+                GL_TEXTURE_2D,
+                0,
+                internalFormat,
+                level.width,
+                level.height,
+                0,
+                dataFormat,
+                GL_UNSIGNED_BYTE,
+                source(level));
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+            glGenerateMipmap(GL_TEXTURE_2D);
         }
-        else if (channels == 4)
+        else
         {
-            dataFormat = GL_RGBA;
-            internalFormat = gamma ? GL_SRGB_ALPHA : GL_RGBA;
+            GLenum internalFormat = CompressedFormat(data);
+            for (size_t i = 0; i < data.levels.size(); ++i)
+            {
+                const TextureLevel &level = data.levels[i];
+                glCompressedTexImage2D(
+                    GL_TEXTURE_2D,
+                    (GLint)i,
+                    internalFormat,
+                    level.width,
+                    level.height,
+                    0,
+                    (GLsizei)level.data.size(),
+                    source(level));
+            }
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)data.levels.size() - 1);
         }
 
-        glGenTextures(1, &ID);
-        glBindTexture(GL_TEXTURE_2D, ID);
-
-        glTexImage2D(
-            GL_TEXTURE_2D,
-            0,
-            internalFormat,
-            width,
-            height,
-            0,
-            dataFormat,
-            GL_UNSIGNED_BYTE,
-            data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-
         // Texture parameters
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    }
 
-        stbi_image_free(data);
+private:
+    void LoadFromFile(const std::string &path)
+    {
+        if (CanCompress(gamma))
+            Upload(TextureCompiler::LoadCompressed(path, gamma));
+        else
+            Upload(TextureCompiler::Decode(path, gamma));
     }
-};
\ No newline at end of file
+
+    static GLuint Placeholder()
+    {
+        static GLuint placeholder = 0;
+        if (!placeholder)
+        {
+            const unsigned char grey[4] = {128, 128, 128, 255};
+            glGenTextures(1, &placeholder);
+            glBindTexture(GL_TEXTURE_2D, placeholder);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, grey);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        }
+        return placeholder;
+    }
+
+    static GLenum CompressedFormat(const TextureData &data)
+    {
+        switch (data.codec)
+        {
+        case TextureCodec::BC1:
+            return data.srgb ? GL_COMPRESSED_SRGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+        case TextureCodec::BC3:
+            return data.srgb ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        case TextureCodec::BC4:
+            return GL_COMPRESSED_RED_RGTC1;
+        default:
+            throw std::runtime_error("Unsupported texture codec");
+        }
+    }
+};
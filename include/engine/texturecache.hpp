@@ -0,0 +1,130 @@
+#pragma once
+#include <engine/singleton.hpp>
+#include <engine/texture2D.hpp>
+#include <engine/render/texturestreamer.hpp>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+// Shares one Texture2D per (file, sRGB, type). Entries are weak, so a texture
+// is released as soon as the last mesh or UI element holding it goes away.
+class TextureCache : public Singleton<TextureCache>
+{
+    friend class Singleton<TextureCache>; // REQUIRED
+
+public:
+    struct Stats
+    {
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t live = 0;
+    };
+
+    std::shared_ptr<Texture2D> Load(const std::string &path, Type type = Type::DIFFUSE, bool gamma = true)
+    {
+        return Find(path, type, gamma, [&]()
+                    { return std::make_shared<Texture2D>(path, type, gamma); });
+    }
+
+    // Same as Load, but a miss is decoded and uploaded in the background by TextureStreamer.
+    std::shared_ptr<Texture2D> LoadAsync(const std::string &path, Type type = Type::DIFFUSE, bool gamma = true)
+    {
+        return Find(path, type, gamma, [&]()
+                    { return TextureStreamer::Get().Load(path, type, gamma); });
+    }
+
+    // Removes entries whose texture has already been released.
+    void Prune()
+    {
+        for (auto it = entries.begin(); it != entries.end();)
+        {
+            if (it->second.expired())
+                it = entries.erase(it);
+            else
+                ++it;
+        }
+    }
+
+    Stats GetStats() const
+    {
+        Stats out = stats;
+        out.live = 0;
+        for (auto &[key, texture] : entries)
+            if (!texture.expired())
+                out.live++;
+        return out;
+    }
+
+    void ResetStats() { stats = {}; }
+
+private:
+    struct Key
+    {
+        std::string path;
+        bool gamma;
+        Type type;
+
+        bool operator==(const Key &other) const
+        {
+            return gamma == other.gamma && type == other.type && path == other.path;
+        }
+    };
+
+    struct KeyHash
+    {
+        size_t operator()(const Key &key) const
+        {
+            size_t h = std::hash<std::string>()(key.path);
+            h ^= (size_t)key.gamma + 0x9e3779b9 + (h << 6) + (h >> 2);
+            h ^= (size_t)key.type + 0x9e3779b9 + (h << 6) + (h >> 2);
+            return h;
+        }
+    };
+
+    TextureCache() = default;
+
+    template <typename Create>
+    std::shared_ptr<Texture2D> Find(const std::string &path, Type type, bool gamma, Create &&create)
+    {
+        Key key{Canonical(path), gamma, type};
+
+        auto it = entries.find(key);
+        if (it != entries.end())
+        {
+            if (auto texture = it->second.lock())
+            {
+                stats.hits++;
+                return texture;
+            }
+            entries.erase(it);
+        }
+
+        stats.misses++;
+        std::shared_ptr<Texture2D> texture = create();
+        entries[key] = texture;
+
+        // Drop expired entries now and then so the map tracks what's resident.
+        if (entries.size() > pruneAt)
+        {
+            Prune();
+            pruneAt = entries.size() * 2 + 16;
+        }
+        return texture;
+    }
+
+    // "dir/../tex.png" and "tex.png" must map to the same entry.
+    static std::string Canonical(const std::string &path)
+    {
+        std::error_code ec;
+        std::filesystem::path p = std::filesystem::weakly_canonical(path, ec);
+        if (ec)
+            p = std::filesystem::path(path).lexically_normal();
+        return p.generic_string();
+    }
+
+    std::unordered_map<Key, std::weak_ptr<Texture2D>, KeyHash> entries;
+    size_t pruneAt = 64;
+    Stats stats;
+};
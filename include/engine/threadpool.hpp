@@ -0,0 +1,148 @@
+#pragma once
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <atomic>
+#include <algorithm>
+#include <engine/singleton.hpp>
+
+class ThreadPool : public Singleton<ThreadPool>
+{
+    friend class Singleton<ThreadPool>; // REQUIRED
+
+public:
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+
+        for (auto &worker : workers)
+            if (worker.joinable())
+                worker.join();
+    }
+
+    template <typename Func>
+    std::future<void> Submit(Func &&func)
+    {
+        auto task = std::make_shared<std::packaged_task<void()>>(std::forward<Func>(func));
+        std::future<void> result = task->get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            jobs.push([task]()
+                      { (*task)(); });
+        }
+        wake.notify_one();
+        return result;
+    }
+
+    // Runs func(i) for i in [0, count) across the workers and the calling thread,
+    // returning once every index has been processed. Helpers share the queue with
+    // background loads, so the caller only waits for indices already being run;
+    // a helper that starts late finds nothing left. Runs inline when called from
+    // a worker, since blocking a worker on queued jobs can deadlock the pool.
+    template <typename Func>
+    void ParallelFor(size_t count, Func &&func)
+    {
+        if (count == 0)
+            return;
+        if (count == 1 || workers.empty() || IsWorkerThread())
+        {
+            for (size_t i = 0; i < count; ++i)
+                func(i);
+            return;
+        }
+
+        // Outlives the call for helpers still in the queue; they never touch func then
+        struct State
+        {
+            std::atomic<size_t> next{0};
+            std::atomic<size_t> done{0};
+            std::mutex mutex;
+            std::condition_variable finished;
+        };
+        auto state = std::make_shared<State>();
+
+        auto body = [state, count, &func]()
+        {
+            for (size_t i = state->next.fetch_add(1); i < count; i = state->next.fetch_add(1))
+            {
+                func(i);
+                if (state->done.fetch_add(1) + 1 == count)
+                {
+                    std::lock_guard<std::mutex> lock(state->mutex);
+                    state->finished.notify_all();
+                }
+            }
+        };
+
+        size_t helpers = std::min(workers.size(), count - 1);
+        for (size_t i = 0; i < helpers; ++i)
+            Enqueue(body);
+
+        body();
+
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->finished.wait(lock, [&state, count]()
+                             { return state->done.load() == count; });
+    }
+
+    size_t WorkerCount() const { return workers.size(); }
+
+    static bool IsWorkerThread() { return isWorker; }
+
+private:
+    ThreadPool()
+    {
+        unsigned int hw = std::thread::hardware_concurrency();
+        size_t count = hw > 1 ? hw - 1 : 1;
+
+        workers.reserve(count);
+        for (size_t i = 0; i < count; ++i)
+            workers.emplace_back([this]()
+                                 { WorkerLoop(); });
+    }
+
+    // Queues a job nobody waits on.
+    void Enqueue(std::function<void()> job)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            jobs.push(std::move(job));
+        }
+        wake.notify_one();
+    }
+
+    void WorkerLoop()
+    {
+        isWorker = true;
+        for (;;)
+        {
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this]()
+                          { return stopping || !jobs.empty(); });
+                if (stopping && jobs.empty())
+                    return;
+                job = std::move(jobs.front());
+                jobs.pop();
+            }
+            job();
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> jobs;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+
+    static inline thread_local bool isWorker = false;
+};
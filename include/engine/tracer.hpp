@@ -0,0 +1,86 @@
+#pragma once
+#include <engine/singleton.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Records wall time of named scopes from any thread while active. Stop() prints
+// a summary sorted by total time and writes a Chrome trace (chrome://tracing,
+// ui.perfetto.dev). Inactive scopes cost one atomic load.
+class Tracer : public Singleton<Tracer>
+{
+    friend class Singleton<Tracer>; // REQUIRED
+
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Event
+    {
+        const char *name; // string literal, also the summary key
+        std::string detail;
+        int64_t start; // microseconds since Start()
+        int64_t duration;
+        uint32_t thread;
+    };
+
+    class Scope
+    {
+    public:
+        Scope(const char *name, std::string detail = {})
+        {
+            if (!Tracer::Get().IsActive())
+                return;
+            this->name = name;
+            this->detail = std::move(detail);
+            start = Clock::now();
+        }
+
+        ~Scope()
+        {
+            if (name)
+                Tracer::Get().Record(name, std::move(detail), start, Clock::now());
+        }
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        const char *name = nullptr;
+        std::string detail;
+        Clock::time_point start;
+    };
+
+    // Clears previous events and starts recording.
+    void Start();
+
+    // Stops recording, prints the summary and writes the trace to tracePath.
+    void Stop(const std::string &tracePath);
+
+    bool IsActive() const { return active.load(std::memory_order_relaxed); }
+
+    void Record(const char *name, std::string detail, Clock::time_point start, Clock::time_point end);
+
+private:
+    Tracer() = default;
+
+    void PrintSummary(double wallMs) const;
+    bool WriteChromeTrace(const std::string &path) const;
+
+    std::atomic<bool> active{false};
+    Clock::time_point epoch;
+
+    mutable std::mutex mutex;
+    std::vector<Event> events;
+    std::unordered_map<std::thread::id, uint32_t> threads;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+// Times the rest of the enclosing block: TRACE_SCOPE("Assimp read", path);
+#define TRACE_SCOPE(...) Tracer::Scope TRACE_CONCAT(traceScope, __LINE__)(__VA_ARGS__)
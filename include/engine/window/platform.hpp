@@ -4,6 +4,7 @@
 #include <stdexcept>
 #include <functional>
 #include <engine/singleton.hpp>
+#include <engine/glext.hpp>
 
 class Platform : public Singleton<Platform>
 {
@@ -11,9 +12,24 @@ class Platform : public Singleton<Platform>
 
 public:
     Platform() = default;
-    void Initialize(int width, int height, const char *title)
+    // headless: no visible window; the GL context renders into an offscreen surface
+    // (SDL's offscreen/EGL driver when available, otherwise a hidden window).
+    void Initialize(int width, int height, const char *title, bool headless = false)
     {
-        if (!SDL_Init(SDL_INIT_VIDEO))
+        this->headless = headless;
+
+        if (headless)
+        {
+            SDL_SetHint(SDL_HINT_VIDEO_DRIVER, "offscreen");
+            if (!SDL_Init(SDL_INIT_VIDEO))
+            {
+                // Offscreen driver not compiled in, use the default one with a hidden window.
+                SDL_ResetHint(SDL_HINT_VIDEO_DRIVER);
+                if (!SDL_Init(SDL_INIT_VIDEO))
+                    throw std::runtime_error("Failed to initialize SDL3.");
+            }
+        }
+        else if (!SDL_Init(SDL_INIT_VIDEO))
         {
             throw std::runtime_error("Failed to initialize SDL3.");
         }
@@ -29,7 +45,7 @@ public:
             title,
             width,
             height,
-            SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE);
+            headless ? (SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN) : (SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE));
         if (!window)
         {
             throw std::runtime_error("Failed to create Window.");
@@ -49,6 +65,7 @@ public:
             SDL_Quit();
             throw std::runtime_error("Failed to initialize glad OpenGL.");
         }
+        GLExt::Load((GLADloadproc)SDL_GL_GetProcAddress);
         running = true;
         lastTime = SDL_GetPerformanceCounter();
     }
@@ -82,10 +99,20 @@ public:
         Uint64 freq = SDL_GetPerformanceFrequency();
         deltaTime = static_cast<float>(currentTime - lastTime) / static_cast<float>(freq);
         lastTime = currentTime;
+
+        // Fixed steps keep headless runs reproducible regardless of frame time.
+        if (fixedDeltaTime > 0.0f)
+            deltaTime = fixedDeltaTime;
     }
 
     void SwapBuffer()
     {
+        if (headless)
+        {
+            // Nothing is presented; wait for the GPU so frame timings are real.
+            glFinish();
+            return;
+        }
         SDL_GL_SwapWindow(window);
     }
 
@@ -103,14 +130,24 @@ public:
         return deltaTime;
     }
 
+    // 0 restores wall clock delta time.
+    void SetFixedDeltaTime(float dt)
+    {
+        fixedDeltaTime = dt;
+    }
+
+    bool IsHeadless() const { return headless; }
+
     SDL_Window *GetWindow() { return window; }
 
 
 private:
     bool running = false;
+    bool headless = false;
 
     Uint64 lastTime = 0;
     float deltaTime = 0.0f;
+    float fixedDeltaTime = 0.0f;
     SDL_Window *window;
     SDL_GLContext gl_context;
     std::function<void(int, int)> callback;
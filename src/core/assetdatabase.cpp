@@ -0,0 +1,282 @@
+#include <engine/assetdatabase.hpp>
+#include <engine/assetpack.hpp>
+#include <engine/filesystem.hpp>
+#include <engine/configure.hpp>
+#include <engine/hash.hpp>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    constexpr char ADB_MAGIC[4] = {'O', 'A', 'D', 'B'};
+    constexpr uint32_t ADB_VERSION = 1;
+
+    struct AdbHeader
+    {
+        char magic[4];
+        uint32_t version;
+        uint32_t sourceCount;
+        uint32_t importCount;
+    };
+
+    std::string DatabasePath()
+    {
+        return (fs::path(ASSET_CACHE_DIR) / "assets.db").string();
+    }
+
+    template <typename T>
+    void WritePod(std::ofstream &out, const T &value)
+    {
+        out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+    }
+
+    template <typename T>
+    bool ReadPod(std::ifstream &in, T &value)
+    {
+        return (bool)in.read(reinterpret_cast<char *>(&value), sizeof(T));
+    }
+
+    void WriteString(std::ofstream &out, const std::string &text)
+    {
+        WritePod(out, (uint32_t)text.size());
+        out.write(text.data(), text.size());
+    }
+
+    bool ReadString(std::ifstream &in, std::string &text)
+    {
+        uint32_t size = 0;
+        if (!ReadPod(in, size) || size > 4096)
+            return false;
+        text.resize(size);
+        return (bool)in.read(text.data(), size);
+    }
+
+    // Smallest encoding of each record, to bound counts before allocating
+    constexpr uint64_t MIN_SOURCE_BYTES = sizeof(uint32_t) + 3 * sizeof(uint64_t);
+    constexpr uint64_t MIN_IMPORT_BYTES = sizeof(uint32_t) + sizeof(uint64_t) + sizeof(uint32_t);
+    constexpr uint64_t MIN_INPUT_BYTES = sizeof(uint32_t) + sizeof(uint64_t);
+
+    // True when count records of at least recordBytes each fit in what is left of in.
+    bool Fits(std::ifstream &in, uint64_t fileSize, uint64_t count, uint64_t recordBytes)
+    {
+        auto pos = in.tellg();
+        return pos >= 0 && (uint64_t)pos <= fileSize && count <= (fileSize - (uint64_t)pos) / recordBytes;
+    }
+}
+
+AssetDatabase::AssetDatabase()
+{
+    if (!Read(DatabasePath()))
+    {
+        sources.clear();
+        imports.clear();
+    }
+}
+
+bool AssetDatabase::ContentHash(const std::string &path, uint64_t &hash)
+{
+    std::string key = PackFormat::NormalizePath(path);
+
+    uint64_t size = 0;
+    int64_t stamp = 0;
+    if (!FileSystem::Get().Stat(path, size, stamp))
+        return false;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = sources.find(key);
+        if (it != sources.end() && it->second.size == size && it->second.stamp == stamp)
+        {
+            hash = it->second.hash;
+            stats.reused++;
+            return true;
+        }
+    }
+
+    // Read outside the lock, loader threads hash different files in parallel
+    FileView file = FileSystem::Get().Open(path);
+    if (!file.IsOpen())
+        return false;
+    hash = Hash::Bytes(file.Data(), file.Size());
+
+    std::lock_guard<std::mutex> lock(mutex);
+    sources[key] = {size, stamp, hash};
+    dirty = true;
+    stats.hashed++;
+    return true;
+}
+
+bool AssetDatabase::IsUpToDate(const std::string &output, uint64_t settings)
+{
+    Import record;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = imports.find(PackFormat::NormalizePath(output));
+        if (it != imports.end())
+            record = it->second;
+    }
+
+    bool current = !record.inputs.empty() && record.settings == settings;
+    for (size_t i = 0; current && i < record.inputs.size(); ++i)
+    {
+        uint64_t hash = 0;
+        current = ContentHash(record.inputs[i].path, hash) && hash == record.inputs[i].hash;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    (current ? stats.upToDate : stats.stale)++;
+    return current;
+}
+
+void AssetDatabase::RecordImport(const std::string &output, uint64_t settings, const std::vector<std::string> &inputs)
+{
+    Import record;
+    record.settings = settings;
+    for (auto &path : inputs)
+    {
+        Input input{PackFormat::NormalizePath(path), 0};
+        // An input that vanished mid-import leaves the output unrecorded, so it is redone
+        if (!ContentHash(path, input.hash))
+            return;
+        record.inputs.push_back(std::move(input));
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    imports[PackFormat::NormalizePath(output)] = std::move(record);
+    dirty = true;
+}
+
+std::vector<std::string> AssetDatabase::GetInputs(const std::string &output) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<std::string> paths;
+    auto it = imports.find(PackFormat::NormalizePath(output));
+    if (it != imports.end())
+        for (auto &input : it->second.inputs)
+            paths.push_back(input.path);
+    return paths;
+}
+
+void AssetDatabase::Save()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!dirty)
+        return;
+
+    if (Write(DatabasePath()))
+        dirty = false;
+    else
+        std::cout << "[AssetDatabase] Cannot write " << DatabasePath() << std::endl;
+}
+
+AssetDatabase::Stats AssetDatabase::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+bool AssetDatabase::Read(const std::string &path)
+{
+    std::error_code ec;
+    uint64_t fileSize = (uint64_t)fs::file_size(path, ec);
+    if (ec)
+        return false;
+
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+        return false;
+
+    AdbHeader header{};
+    if (!ReadPod(in, header))
+        return false;
+    if (std::memcmp(header.magic, ADB_MAGIC, 4) != 0 || header.version != ADB_VERSION)
+        return false;
+
+    // A truncated or corrupt database is discarded, never trusted for allocation sizes
+    if (!Fits(in, fileSize, header.sourceCount, MIN_SOURCE_BYTES) ||
+        !Fits(in, fileSize, header.importCount, MIN_IMPORT_BYTES))
+        return false;
+
+    for (uint32_t i = 0; i < header.sourceCount; ++i)
+    {
+        std::string key;
+        Source source;
+        if (!ReadString(in, key) || !ReadPod(in, source.size) || !ReadPod(in, source.stamp) || !ReadPod(in, source.hash))
+            return false;
+        sources[key] = source;
+    }
+
+    for (uint32_t i = 0; i < header.importCount; ++i)
+    {
+        std::string key;
+        Import record;
+        uint32_t inputCount = 0;
+        if (!ReadString(in, key) || !ReadPod(in, record.settings) || !ReadPod(in, inputCount))
+            return false;
+        if (!Fits(in, fileSize, inputCount, MIN_INPUT_BYTES))
+            return false;
+
+        record.inputs.resize(inputCount);
+        for (auto &input : record.inputs)
+            if (!ReadString(in, input.path) || !ReadPod(in, input.hash))
+                return false;
+        imports[key] = std::move(record);
+    }
+    return true;
+}
+
+bool AssetDatabase::Write(const std::string &path) const
+{
+    std::error_code ec;
+    fs::create_directories(fs::path(path).parent_path(), ec);
+
+    // Same temp-then-rename as the other cache files, never a truncated database
+    std::string temp = path + ".tmp";
+    {
+        std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+        if (!out)
+            return false;
+
+        AdbHeader header{};
+        std::memcpy(header.magic, ADB_MAGIC, 4);
+        header.version = ADB_VERSION;
+        header.sourceCount = (uint32_t)sources.size();
+        header.importCount = (uint32_t)imports.size();
+        WritePod(out, header);
+
+        for (auto &[key, source] : sources)
+        {
+            WriteString(out, key);
+            WritePod(out, source.size);
+            WritePod(out, source.stamp);
+            WritePod(out, source.hash);
+        }
+
+        for (auto &[key, record] : imports)
+        {
+            WriteString(out, key);
+            WritePod(out, record.settings);
+            WritePod(out, (uint32_t)record.inputs.size());
+            for (auto &input : record.inputs)
+            {
+                WriteString(out, input.path);
+                WritePod(out, input.hash);
+            }
+        }
+
+        if (!out)
+            return false;
+    }
+
+    fs::rename(temp, path, ec);
+    if (ec)
+    {
+        fs::remove(temp, ec);
+        return false;
+    }
+    return true;
+}
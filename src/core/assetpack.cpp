@@ -0,0 +1,250 @@
+#include <engine/assetpack.hpp>
+#include <engine/hash.hpp>
+#include <engine/lz4.hpp>
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace fs = std::filesystem;
+
+namespace PackFormat
+{
+    std::string NormalizePath(const std::string &path)
+    {
+        std::string normal = fs::path(path).lexically_normal().generic_string();
+        while (normal.rfind("./", 0) == 0)
+            normal.erase(0, 2);
+        return normal;
+    }
+
+    uint64_t HashPath(const std::string &normalizedPath)
+    {
+        return Hash::Fnv1a(normalizedPath);
+    }
+}
+
+// ------------------------
+// Reading
+// ------------------------
+
+std::shared_ptr<AssetPack> AssetPack::Open(const std::string &path)
+{
+    auto pack = std::make_shared<AssetPack>();
+    if (!pack->file.Open(path))
+        return nullptr;
+
+    pack->filePath = path;
+    pack->data = pack->file.Data();
+    pack->size = pack->file.Size();
+    if (!pack->Validate())
+    {
+        std::cout << "[AssetPack] Invalid pack: " << path << std::endl;
+        return nullptr;
+    }
+    return pack;
+}
+
+bool AssetPack::Validate()
+{
+    using namespace PackFormat;
+
+    if (size < sizeof(Header))
+        return false;
+    const Header &header = GetHeader();
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION)
+        return false;
+
+    if (header.tocOffset > size || header.tocOffset % alignof(Entry) != 0 ||
+        (uint64_t)header.entryCount * sizeof(Entry) > size - header.tocOffset)
+        return false;
+    if (header.stringsOffset > size || header.stringsSize > size - header.stringsOffset)
+        return false;
+
+    toc = reinterpret_cast<const Entry *>(data + header.tocOffset);
+    for (uint32_t i = 0; i < header.entryCount; ++i)
+    {
+        const Entry &entry = toc[i];
+        if (entry.offset > size || entry.storedSize > size - entry.offset)
+            return false;
+        if ((uint64_t)entry.pathOffset + entry.pathLength > header.stringsSize)
+            return false;
+        if (entry.compression != Compression::None && entry.compression != Compression::LZ4)
+            return false;
+        if (entry.compression == Compression::None && entry.storedSize != entry.rawSize)
+            return false;
+        // Open allocates rawSize before decoding; LZ4 cannot expand past 255:1
+        if (entry.compression == Compression::LZ4 && entry.rawSize > entry.storedSize * 255)
+            return false;
+        if (i > 0 && toc[i - 1].pathHash > entry.pathHash)
+            return false;
+    }
+    return true;
+}
+
+const PackFormat::Entry *AssetPack::Find(const std::string &normalizedPath) const
+{
+    uint64_t hash = PackFormat::HashPath(normalizedPath);
+    const PackFormat::Entry *end = toc + GetHeader().entryCount;
+
+    auto it = std::lower_bound(toc, end, hash, [](const PackFormat::Entry &entry, uint64_t value)
+                               { return entry.pathHash < value; });
+
+    // Hash collisions are resolved by comparing the stored path
+    for (; it != end && it->pathHash == hash; ++it)
+        if (it->pathLength == normalizedPath.size() &&
+            std::memcmp(data + GetHeader().stringsOffset + it->pathOffset, normalizedPath.data(), it->pathLength) == 0)
+            return it;
+
+    return nullptr;
+}
+
+bool AssetPack::Extract(const PackFormat::Entry &entry, uint8_t *dst) const
+{
+    if (entry.compression == PackFormat::Compression::None)
+    {
+        std::memcpy(dst, GetStored(entry), (size_t)entry.rawSize);
+        return true;
+    }
+    return LZ4::Decompress(GetStored(entry), (size_t)entry.storedSize, dst, (size_t)entry.rawSize);
+}
+
+std::string AssetPack::GetPath(const PackFormat::Entry &entry) const
+{
+    const char *strings = reinterpret_cast<const char *>(data + GetHeader().stringsOffset);
+    return std::string(strings + entry.pathOffset, entry.pathLength);
+}
+
+// ------------------------
+// Writing
+// ------------------------
+
+void AssetPackWriter::Add(const std::string &path, const std::string &sourceFile)
+{
+    pending.push_back({PackFormat::NormalizePath(path), sourceFile});
+}
+
+bool AssetPackWriter::Write(const std::string &path)
+{
+    using namespace PackFormat;
+
+    // Sorted by hash so readers can binary search the table in place
+    std::sort(pending.begin(), pending.end(), [](const Pending &a, const Pending &b)
+              {
+        uint64_t ha = HashPath(a.path), hb = HashPath(b.path);
+        return ha != hb ? ha < hb : a.path < b.path; });
+
+    for (size_t i = 1; i < pending.size(); ++i)
+        if (pending[i].path == pending[i - 1].path)
+        {
+            std::cout << "[AssetPack] Duplicate path: " << pending[i].path << std::endl;
+            return false;
+        }
+
+    std::error_code ec;
+    if (fs::path(path).has_parent_path())
+        fs::create_directories(fs::path(path).parent_path(), ec);
+
+    std::string temp = path + ".tmp";
+    std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+    if (!out)
+        return false;
+
+    auto pad = [&out]()
+    {
+        static const char zeros[ALIGNMENT] = {};
+        uint64_t at = (uint64_t)out.tellp();
+        if (uint64_t rem = at % ALIGNMENT)
+            out.write(zeros, (std::streamsize)(ALIGNMENT - rem));
+    };
+
+    Header header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.entryCount = (uint32_t)pending.size();
+    header.alignment = ALIGNMENT;
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+    std::vector<Entry> toc;
+    toc.reserve(pending.size());
+    std::string strings;
+    std::vector<uint8_t> packed;
+
+    stats = {};
+    for (auto &item : pending)
+    {
+        // One source file mapped at a time, packs can be larger than memory
+        MappedFile source(item.sourceFile);
+        if (!source.IsOpen() && fs::file_size(item.sourceFile, ec) != 0)
+        {
+            std::cout << "[AssetPack] Cannot read: " << item.sourceFile << std::endl;
+            out.close();
+            fs::remove(temp, ec);
+            return false;
+        }
+        const uint8_t *bytes = source.Data();
+        size_t byteCount = source.Size();
+
+        Entry entry{};
+        entry.pathHash = HashPath(item.path);
+        entry.contentHash = Hash::Bytes(bytes, byteCount);
+        entry.rawSize = byteCount;
+        entry.pathOffset = (uint32_t)strings.size();
+        entry.pathLength = (uint32_t)item.path.size();
+        strings += item.path;
+
+        const uint8_t *stored = bytes;
+        entry.storedSize = entry.rawSize;
+        entry.compression = Compression::None;
+
+        if (compress && byteCount)
+        {
+            packed.resize(LZ4::CompressBound(byteCount));
+            size_t packedSize = LZ4::Compress(bytes, byteCount, packed.data(), packed.size());
+            if (packedSize && packedSize <= (size_t)((1.0f - minSavings) * (float)byteCount))
+            {
+                stored = packed.data();
+                entry.storedSize = packedSize;
+                entry.compression = Compression::LZ4;
+                stats.compressed++;
+            }
+        }
+
+        pad();
+        entry.offset = (uint64_t)out.tellp();
+        out.write(reinterpret_cast<const char *>(stored), (std::streamsize)entry.storedSize);
+        toc.push_back(entry);
+
+        stats.files++;
+        stats.rawBytes += entry.rawSize;
+        stats.storedBytes += entry.storedSize;
+    }
+
+    pad();
+    header.tocOffset = (uint64_t)out.tellp();
+    out.write(reinterpret_cast<const char *>(toc.data()), (std::streamsize)(toc.size() * sizeof(Entry)));
+
+    header.stringsOffset = (uint64_t)out.tellp();
+    header.stringsSize = strings.size();
+    out.write(strings.data(), (std::streamsize)strings.size());
+
+    out.seekp(0);
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.close();
+    if (!out)
+    {
+        fs::remove(temp, ec);
+        return false;
+    }
+
+    pending.clear();
+
+    fs::rename(temp, path, ec);
+    if (ec)
+    {
+        fs::remove(temp, ec);
+        return false;
+    }
+    return true;
+}
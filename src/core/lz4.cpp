@@ -0,0 +1,198 @@
+#include <engine/lz4.hpp>
+#include <cstring>
+
+namespace
+{
+    constexpr size_t MIN_MATCH = 4;
+    constexpr size_t LAST_LITERALS = 5; // the block always ends with this many literals
+    constexpr size_t MF_LIMIT = 12;     // no match may start closer to the end than this
+    constexpr size_t MAX_OFFSET = 65535;
+    constexpr int HASH_BITS = 12;
+
+    uint32_t Read32(const uint8_t *p)
+    {
+        uint32_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    uint32_t HashSequence(uint32_t sequence)
+    {
+        return (sequence * 2654435761u) >> (32 - HASH_BITS);
+    }
+
+    // Bounds-checked output cursor; fails sticky once capacity is exceeded.
+    struct Writer
+    {
+        uint8_t *dst;
+        size_t capacity;
+        size_t pos = 0;
+        bool overflow = false;
+
+        void Byte(uint8_t value)
+        {
+            if (pos >= capacity)
+            {
+                overflow = true;
+                return;
+            }
+            dst[pos++] = value;
+        }
+
+        void Bytes(const uint8_t *src, size_t count)
+        {
+            if (count > capacity - pos)
+            {
+                overflow = true;
+                return;
+            }
+            std::memcpy(dst + pos, src, count);
+            pos += count;
+        }
+
+        // Length continuation bytes after a saturated token nibble.
+        void Length(size_t length)
+        {
+            for (; length >= 255; length -= 255)
+                Byte(255);
+            Byte((uint8_t)length);
+        }
+    };
+
+    void EmitSequence(Writer &out, const uint8_t *literals, size_t literalCount, size_t offset, size_t matchLength)
+    {
+        size_t matchCode = matchLength - MIN_MATCH;
+        uint8_t token = (uint8_t)((literalCount >= 15 ? 15 : literalCount) << 4);
+        token |= (uint8_t)(matchCode >= 15 ? 15 : matchCode);
+
+        out.Byte(token);
+        if (literalCount >= 15)
+            out.Length(literalCount - 15);
+        out.Bytes(literals, literalCount);
+
+        out.Byte((uint8_t)(offset & 0xFF));
+        out.Byte((uint8_t)(offset >> 8));
+        if (matchCode >= 15)
+            out.Length(matchCode - 15);
+    }
+
+    void EmitLastLiterals(Writer &out, const uint8_t *literals, size_t literalCount)
+    {
+        out.Byte((uint8_t)((literalCount >= 15 ? 15 : literalCount) << 4));
+        if (literalCount >= 15)
+            out.Length(literalCount - 15);
+        out.Bytes(literals, literalCount);
+    }
+}
+
+namespace LZ4
+{
+    size_t Compress(const uint8_t *src, size_t size, uint8_t *dst, size_t capacity)
+    {
+        Writer out{dst, capacity};
+        size_t anchor = 0;
+
+        if (size > MF_LIMIT)
+        {
+            uint32_t table[1 << HASH_BITS] = {};
+            const size_t matchLimit = size - LAST_LITERALS;
+            const size_t inputLimit = size - MF_LIMIT;
+
+            size_t ip = 0;
+            while (ip < inputLimit)
+            {
+                uint32_t sequence = Read32(src + ip);
+                uint32_t &slot = table[HashSequence(sequence)];
+                size_t ref = slot;
+                slot = (uint32_t)ip;
+
+                if (ref >= ip || ip - ref > MAX_OFFSET || Read32(src + ref) != sequence)
+                {
+                    ip++;
+                    continue;
+                }
+
+                // Grow the match backwards into pending literals, then forwards
+                while (ip > anchor && ref > 0 && src[ip - 1] == src[ref - 1])
+                {
+                    ip--;
+                    ref--;
+                }
+                size_t length = MIN_MATCH;
+                while (ip + length < matchLimit && src[ref + length] == src[ip + length])
+                    length++;
+
+                EmitSequence(out, src + anchor, ip - anchor, ip - ref, length);
+                if (out.overflow)
+                    return 0;
+
+                ip += length;
+                anchor = ip;
+            }
+        }
+
+        EmitLastLiterals(out, src + anchor, size - anchor);
+        return out.overflow ? 0 : out.pos;
+    }
+
+    bool Decompress(const uint8_t *src, size_t size, uint8_t *dst, size_t rawSize)
+    {
+        size_t ip = 0, op = 0;
+
+        auto readLength = [&](size_t &length) -> bool
+        {
+            uint8_t byte;
+            do
+            {
+                if (ip >= size)
+                    return false;
+                byte = src[ip++];
+                length += byte;
+            } while (byte == 255);
+            return true;
+        };
+
+        while (ip < size)
+        {
+            uint8_t token = src[ip++];
+
+            size_t literals = token >> 4;
+            if (literals == 15 && !readLength(literals))
+                return false;
+            if (literals > size - ip || literals > rawSize - op)
+                return false;
+            std::memcpy(dst + op, src + ip, literals);
+            ip += literals;
+            op += literals;
+
+            // The last sequence has no match part
+            if (ip == size)
+                break;
+
+            if (size - ip < 2)
+                return false;
+            size_t offset = (size_t)src[ip] | ((size_t)src[ip + 1] << 8);
+            ip += 2;
+            if (offset == 0 || offset > op)
+                return false;
+
+            size_t length = token & 15;
+            if (length == 15 && !readLength(length))
+                return false;
+            length += MIN_MATCH;
+            if (length > rawSize - op)
+                return false;
+
+            // Overlapping copies repeat the last offset bytes, so go byte by byte
+            const uint8_t *match = dst + op - offset;
+            if (offset >= length)
+                std::memcpy(dst + op, match, length);
+            else
+                for (size_t i = 0; i < length; ++i)
+                    dst[op + i] = match[i];
+            op += length;
+        }
+
+        return op == rawSize;
+    }
+}
@@ -0,0 +1,92 @@
+#include <engine/mappedfile.hpp>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+bool MappedFile::Open(const std::string &path)
+{
+    Close();
+#ifdef _WIN32
+    HANDLE handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (handle == INVALID_HANDLE_VALUE)
+        return false;
+    file = handle;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(handle, &fileSize) || fileSize.QuadPart == 0)
+    {
+        Close();
+        return false;
+    }
+
+    mapping = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping)
+    {
+        Close();
+        return false;
+    }
+
+    data = static_cast<const uint8_t *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!data)
+    {
+        Close();
+        return false;
+    }
+    size = (size_t)fileSize.QuadPart;
+#else
+    fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0)
+    {
+        Close();
+        return false;
+    }
+
+    void *view = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (view == MAP_FAILED)
+    {
+        Close();
+        return false;
+    }
+    data = static_cast<const uint8_t *>(view);
+    size = (size_t)info.st_size;
+#endif
+    return true;
+}
+
+void MappedFile::Close()
+{
+#ifdef _WIN32
+    if (data)
+        UnmapViewOfFile(data);
+    if (mapping)
+        CloseHandle(mapping);
+    if (file)
+        CloseHandle(file);
+    mapping = nullptr;
+    file = nullptr;
+#else
+    if (data)
+        munmap(const_cast<uint8_t *>(data), size);
+    if (fd >= 0)
+        ::close(fd);
+    fd = -1;
+#endif
+    data = nullptr;
+    size = 0;
+}
@@ -0,0 +1,190 @@
+#include <engine/render/meshlet.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    Meshlet Finish(const std::vector<uint32_t> &indices, const std::vector<glm::vec3> &positions, size_t firstTriangle, size_t endTriangle)
+    {
+        Meshlet meshlet{};
+        meshlet.firstIndex = (uint32_t)(firstTriangle * 3);
+        meshlet.indexCount = (uint32_t)((endTriangle - firstTriangle) * 3);
+
+        // Sphere around the box centre; a little loose but cheap and stable
+        glm::vec3 min(positions[indices[firstTriangle * 3]]), max(min);
+        for (size_t i = firstTriangle * 3; i < endTriangle * 3; ++i)
+        {
+            min = glm::min(min, positions[indices[i]]);
+            max = glm::max(max, positions[indices[i]]);
+        }
+        meshlet.center = (min + max) * 0.5f;
+
+        float radiusSq = 0.0f;
+        for (size_t i = firstTriangle * 3; i < endTriangle * 3; ++i)
+        {
+            glm::vec3 d = positions[indices[i]] - meshlet.center;
+            radiusSq = std::max(radiusSq, glm::dot(d, d));
+        }
+        meshlet.radius = std::sqrt(radiusSq);
+
+        // Normal cone: average facing, widened to the least aligned triangle
+        std::vector<glm::vec3> normals;
+        normals.reserve(endTriangle - firstTriangle);
+        glm::vec3 sum(0.0f);
+        for (size_t t = firstTriangle; t < endTriangle; ++t)
+        {
+            const glm::vec3 &a = positions[indices[t * 3]];
+            const glm::vec3 &b = positions[indices[t * 3 + 1]];
+            const glm::vec3 &c = positions[indices[t * 3 + 2]];
+
+            glm::vec3 n = glm::cross(b - a, c - a);
+            float length = glm::length(n);
+            if (length <= 0.0f)
+                continue;
+            n /= length;
+            normals.push_back(n);
+            sum += n;
+        }
+
+        meshlet.coneAxis = glm::vec3(0.0f, 0.0f, 1.0f);
+        meshlet.coneCutoff = 1.0f;
+
+        float sumLength = glm::length(sum);
+        if (normals.empty() || sumLength <= 0.0f)
+            return meshlet;
+
+        meshlet.coneAxis = sum / sumLength;
+        float minDot = 1.0f;
+        for (auto &n : normals)
+            minDot = std::min(minDot, glm::dot(n, meshlet.coneAxis));
+
+        // Nearly a hemisphere or wider: some triangle always faces the camera
+        if (minDot > 0.1f)
+            meshlet.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+        return meshlet;
+    }
+}
+
+namespace Meshlets
+{
+    std::vector<Meshlet> Build(const std::vector<uint32_t> &indices, const std::vector<glm::vec3> &positions)
+    {
+        std::vector<Meshlet> meshlets;
+        const size_t triangleCount = indices.size() / 3;
+        if (triangleCount == 0)
+            return meshlets;
+
+        // owner[v] is the number of the last meshlet that counted vertex v
+        std::vector<uint32_t> owner(positions.size(), 0);
+        uint32_t current = 1;
+        uint32_t vertexCount = 0;
+        size_t first = 0;
+
+        auto newVertices = [&owner](const uint32_t *triangle, uint32_t meshlet)
+        {
+            uint32_t count = 0;
+            for (int k = 0; k < 3; ++k)
+            {
+                uint32_t v = triangle[k];
+                bool repeated = (k > 0 && v == triangle[0]) || (k > 1 && v == triangle[1]);
+                if (!repeated && owner[v] != meshlet)
+                    count++;
+            }
+            return count;
+        };
+
+        for (size_t t = 0; t < triangleCount; ++t)
+        {
+            const uint32_t *triangle = &indices[t * 3];
+            uint32_t added = newVertices(triangle, current);
+
+            if (vertexCount + added > MAX_VERTICES || t - first >= MAX_TRIANGLES)
+            {
+                meshlets.push_back(Finish(indices, positions, first, t));
+                first = t;
+                vertexCount = 0;
+                current++;
+                added = newVertices(triangle, current);
+            }
+
+            for (int k = 0; k < 3; ++k)
+                owner[triangle[k]] = current;
+            vertexCount += added;
+        }
+
+        meshlets.push_back(Finish(indices, positions, first, triangleCount));
+        return meshlets;
+    }
+}
+
+void MeshletCuller::Begin(const glm::mat4 &viewProjection, const glm::vec3 &cameraPosition)
+{
+    camera = cameraPosition;
+    stats = {};
+
+    // Gribb-Hartmann: left, right, bottom, top, near, far
+    glm::vec4 row[4];
+    for (int i = 0; i < 4; ++i)
+        row[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+
+    planes[0] = row[3] + row[0];
+    planes[1] = row[3] - row[0];
+    planes[2] = row[3] + row[1];
+    planes[3] = row[3] - row[1];
+    planes[4] = row[3] + row[2];
+    planes[5] = row[3] - row[2];
+    for (auto &plane : planes)
+        plane /= glm::length(glm::vec3(plane));
+}
+
+void MeshletCuller::Cull(const std::vector<Meshlet> &meshlets, const glm::mat4 &model, std::vector<IndexRange> &out)
+{
+    glm::vec3 axisScale(glm::length(glm::vec3(model[0])), glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2])));
+    float maxScale = std::max({axisScale.x, axisScale.y, axisScale.z});
+    float minScale = std::min({axisScale.x, axisScale.y, axisScale.z});
+
+    // Cone angles only survive rotation and uniform scale; mirroring flips facing
+    bool coneValid = minScale > 0.0f && maxScale <= minScale * 1.01f;
+    glm::mat3 basis(model);
+    float facing = glm::determinant(basis) < 0.0f ? -1.0f : 1.0f;
+
+    size_t begin = out.size();
+    for (const Meshlet &meshlet : meshlets)
+    {
+        stats.meshlets++;
+        stats.triangles += meshlet.indexCount / 3;
+
+        glm::vec3 center = glm::vec3(model * glm::vec4(meshlet.center, 1.0f));
+        float radius = meshlet.radius * maxScale;
+
+        bool inside = true;
+        for (const glm::vec4 &plane : planes)
+            if (glm::dot(glm::vec3(plane), center) + plane.w < -radius)
+            {
+                inside = false;
+                break;
+            }
+        if (!inside)
+        {
+            stats.frustumCulled++;
+            continue;
+        }
+
+        if (coneValid && meshlet.coneCutoff < 1.0f)
+        {
+            glm::vec3 axis = glm::normalize(basis * meshlet.coneAxis) * facing;
+            glm::vec3 view = center - camera;
+            if (glm::dot(view, axis) >= meshlet.coneCutoff * glm::length(view) + radius)
+            {
+                stats.backfaceCulled++;
+                continue;
+            }
+        }
+
+        stats.visibleTriangles += meshlet.indexCount / 3;
+        if (out.size() > begin && out.back().firstIndex + out.back().indexCount == meshlet.firstIndex)
+            out.back().indexCount += meshlet.indexCount;
+        else
+            out.push_back({meshlet.firstIndex, meshlet.indexCount});
+    }
+}
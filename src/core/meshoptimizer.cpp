@@ -0,0 +1,435 @@
+#include <engine/render/meshoptimizer.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace
+{
+    // ------------------------
+    // Forsyth scoring
+    // ------------------------
+    constexpr int LRU_SIZE = 32;
+    constexpr float LAST_TRIANGLE_SCORE = 0.75f;
+    constexpr float CACHE_DECAY_POWER = 1.5f;
+    constexpr float VALENCE_BOOST_SCALE = 2.0f;
+    constexpr float VALENCE_BOOST_POWER = 0.5f;
+
+    float VertexScore(int cachePosition, uint32_t liveTriangles)
+    {
+        // Nothing left to draw with this vertex
+        if (liveTriangles == 0)
+            return -1.0f;
+
+        float score = 0.0f;
+        if (cachePosition >= 0)
+        {
+            // The last triangle's vertices get a fixed score so the next triangle
+            // does not simply reuse its edge and produce long thin strips.
+            if (cachePosition < 3)
+                score = LAST_TRIANGLE_SCORE;
+            else
+                score = std::pow(1.0f - (float)(cachePosition - 3) / (float)(LRU_SIZE - 3), CACHE_DECAY_POWER);
+        }
+
+        // Finish off vertices with few triangles left so they can leave the cache
+        score += VALENCE_BOOST_SCALE * std::pow((float)liveTriangles, -VALENCE_BOOST_POWER);
+        return score;
+    }
+
+    // FIFO cache model with timestamps: a vertex hits while fewer than cacheSize
+    // misses happened since it was last loaded.
+    struct FifoCache
+    {
+        std::vector<uint32_t> stamp;
+        uint32_t cacheSize;
+        uint32_t time;
+
+        FifoCache(size_t vertexCount, uint32_t cacheSize)
+            : stamp(vertexCount, 0), cacheSize(cacheSize), time(cacheSize + 1) {}
+
+        // Returns 1 on a miss
+        uint32_t Access(uint32_t vertex)
+        {
+            if (time - stamp[vertex] > cacheSize)
+            {
+                stamp[vertex] = time++;
+                return 1;
+            }
+            return 0;
+        }
+
+        void Flush()
+        {
+            time += cacheSize + 1;
+        }
+    };
+
+    uint32_t TriangleMisses(FifoCache &cache, const uint32_t *triangle)
+    {
+        return cache.Access(triangle[0]) + cache.Access(triangle[1]) + cache.Access(triangle[2]);
+    }
+
+    // ------------------------
+    // Overdraw raster
+    // ------------------------
+    constexpr int OVERDRAW_GRID = 256;
+
+    struct RasterStats
+    {
+        size_t shaded = 0;
+        size_t covered = 0;
+    };
+
+    // Draws the triangles seen from +axis (side 0) or -axis (side 1) with an
+    // early depth test, counting shaded and finally covered pixels.
+    void RasterizeView(const std::vector<glm::vec3> &projected, int side, std::vector<float> &depth, RasterStats &stats)
+    {
+        std::fill(depth.begin(), depth.end(), std::numeric_limits<float>::max());
+
+        for (size_t t = 0; t + 2 < projected.size(); t += 3)
+        {
+            glm::vec3 a = projected[t], b = projected[t + 1], c = projected[t + 2];
+
+            // Viewing along -axis flips the winding
+            float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+            if (side == 1)
+                area = -area;
+            if (area <= 0.0f)
+                continue;
+
+            if (side == 1)
+                std::swap(b, c);
+            float z0 = side == 0 ? -a.z : a.z;
+            float z1 = side == 0 ? -b.z : b.z;
+            float z2 = side == 0 ? -c.z : c.z;
+
+            int minX = std::max(0, (int)std::floor(std::min({a.x, b.x, c.x})));
+            int maxX = std::min(OVERDRAW_GRID - 1, (int)std::ceil(std::max({a.x, b.x, c.x})));
+            int minY = std::max(0, (int)std::floor(std::min({a.y, b.y, c.y})));
+            int maxY = std::min(OVERDRAW_GRID - 1, (int)std::ceil(std::max({a.y, b.y, c.y})));
+
+            for (int y = minY; y <= maxY; ++y)
+                for (int x = minX; x <= maxX; ++x)
+                {
+                    float px = (float)x + 0.5f, py = (float)y + 0.5f;
+                    float w0 = (c.x - b.x) * (py - b.y) - (c.y - b.y) * (px - b.x);
+                    float w1 = (a.x - c.x) * (py - c.y) - (a.y - c.y) * (px - c.x);
+                    float w2 = (b.x - a.x) * (py - a.y) - (b.y - a.y) * (px - a.x);
+                    if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f)
+                        continue;
+
+                    float sum = w0 + w1 + w2;
+                    float z = (w0 * z0 + w1 * z1 + w2 * z2) / sum;
+
+                    float &stored = depth[(size_t)y * OVERDRAW_GRID + x];
+                    if (z < stored)
+                    {
+                        stored = z;
+                        stats.shaded++;
+                    }
+                }
+        }
+
+        for (float d : depth)
+            if (d != std::numeric_limits<float>::max())
+                stats.covered++;
+    }
+}
+
+namespace MeshOptimizer
+{
+    void OptimizeVertexCache(std::vector<uint32_t> &indices, size_t vertexCount)
+    {
+        const size_t triangleCount = indices.size() / 3;
+        if (triangleCount < 2)
+            return;
+
+        // Per vertex list of triangles still to be drawn (first live[v] entries)
+        std::vector<uint32_t> live(vertexCount, 0);
+        for (uint32_t v : indices)
+            live[v]++;
+
+        std::vector<uint32_t> offsets(vertexCount + 1, 0);
+        for (size_t v = 0; v < vertexCount; ++v)
+            offsets[v + 1] = offsets[v] + live[v];
+
+        std::vector<uint32_t> adjacency(indices.size());
+        {
+            std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+            for (size_t i = 0; i < indices.size(); ++i)
+                adjacency[fill[indices[i]]++] = (uint32_t)(i / 3);
+        }
+
+        std::vector<int> cachePosition(vertexCount, -1);
+        std::vector<float> vertexScore(vertexCount);
+        for (size_t v = 0; v < vertexCount; ++v)
+            vertexScore[v] = VertexScore(-1, live[v]);
+
+        std::vector<float> triangleScore(triangleCount);
+        for (size_t t = 0; t < triangleCount; ++t)
+            triangleScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+
+        std::vector<bool> emitted(triangleCount, false);
+        std::vector<uint32_t> cache, nextCache;
+        cache.reserve(LRU_SIZE + 3);
+        nextCache.reserve(LRU_SIZE + 3);
+
+        std::vector<uint32_t> out;
+        out.reserve(indices.size());
+
+        size_t best = (size_t)(std::max_element(triangleScore.begin(), triangleScore.end()) - triangleScore.begin());
+        size_t scan = 0;
+
+        for (size_t n = 0; n < triangleCount; ++n)
+        {
+            // Nothing in the cache has triangles left: restart from the next undrawn one
+            if (best == SIZE_MAX)
+            {
+                while (emitted[scan])
+                    scan++;
+                best = scan;
+            }
+
+            const uint32_t *triangle = &indices[best * 3];
+            emitted[best] = true;
+
+            nextCache.clear();
+            for (int k = 0; k < 3; ++k)
+            {
+                uint32_t v = triangle[k];
+                out.push_back(v);
+
+                // Drop the triangle from the vertex's live list
+                uint32_t *begin = &adjacency[offsets[v]];
+                uint32_t *end = begin + live[v];
+                uint32_t *it = std::find(begin, end, (uint32_t)best);
+                if (it != end)
+                {
+                    std::swap(*it, *(end - 1));
+                    live[v]--;
+                }
+
+                if (std::find(nextCache.begin(), nextCache.end(), v) == nextCache.end())
+                    nextCache.push_back(v);
+            }
+            for (uint32_t v : cache)
+                if (std::find(nextCache.begin(), nextCache.end(), v) == nextCache.end())
+                    nextCache.push_back(v);
+
+            // Re-score everything that moved in or fell out of the cache
+            for (size_t i = 0; i < nextCache.size(); ++i)
+            {
+                uint32_t v = nextCache[i];
+                int position = i < (size_t)LRU_SIZE ? (int)i : -1;
+                cachePosition[v] = position;
+
+                float score = VertexScore(position, live[v]);
+                float delta = score - vertexScore[v];
+                vertexScore[v] = score;
+                for (uint32_t j = 0; j < live[v]; ++j)
+                    triangleScore[adjacency[offsets[v] + j]] += delta;
+            }
+
+            if (nextCache.size() > (size_t)LRU_SIZE)
+                nextCache.resize(LRU_SIZE);
+            cache.swap(nextCache);
+
+            // Next triangle: best scoring one that touches the cache
+            best = SIZE_MAX;
+            float bestScore = -std::numeric_limits<float>::max();
+            for (uint32_t v : cache)
+                for (uint32_t j = 0; j < live[v]; ++j)
+                {
+                    uint32_t t = adjacency[offsets[v] + j];
+                    if (triangleScore[t] > bestScore)
+                    {
+                        bestScore = triangleScore[t];
+                        best = t;
+                    }
+                }
+        }
+
+        indices.swap(out);
+    }
+
+    void OptimizeOverdraw(std::vector<uint32_t> &indices, const std::vector<glm::vec3> &positions, float threshold)
+    {
+        const size_t triangleCount = indices.size() / 3;
+        if (triangleCount < 2)
+            return;
+
+        // Hard boundaries: triangles where the cache model missed all three vertices,
+        // so starting there costs nothing extra.
+        std::vector<size_t> hard;
+        {
+            FifoCache cache(positions.size(), ANALYSIS_CACHE_SIZE);
+            for (size_t t = 0; t < triangleCount; ++t)
+                if (TriangleMisses(cache, &indices[t * 3]) == 3)
+                    hard.push_back(t);
+        }
+        hard.push_back(triangleCount);
+
+        // Soft boundaries: cut a hard cluster wherever the part since the last cut
+        // already stays within threshold of the cluster's own ACMR.
+        std::vector<size_t> clusters;
+        FifoCache cache(positions.size(), ANALYSIS_CACHE_SIZE);
+        for (size_t h = 0; h + 1 < hard.size(); ++h)
+        {
+            size_t begin = hard[h], end = hard[h + 1];
+
+            cache.Flush();
+            uint32_t clusterMisses = 0;
+            for (size_t t = begin; t < end; ++t)
+                clusterMisses += TriangleMisses(cache, &indices[t * 3]);
+            float clusterAcmr = (float)clusterMisses / (float)(end - begin);
+
+            size_t start = begin;
+            uint32_t misses = 0;
+            cache.Flush();
+            clusters.push_back(begin);
+            for (size_t t = begin; t < end; ++t)
+            {
+                misses += TriangleMisses(cache, &indices[t * 3]);
+                float acmr = (float)misses / (float)(t + 1 - start);
+                if (t + 1 < end && acmr <= clusterAcmr * threshold)
+                {
+                    start = t + 1;
+                    misses = 0;
+                    cache.Flush();
+                    clusters.push_back(start);
+                }
+            }
+        }
+        clusters.push_back(triangleCount);
+
+        // Area weighted centroid and normal per cluster
+        const size_t clusterCount = clusters.size() - 1;
+        std::vector<glm::vec3> centroid(clusterCount, glm::vec3(0.0f)), normal(clusterCount, glm::vec3(0.0f));
+        glm::vec3 meshCentroid(0.0f);
+        float meshArea = 0.0f;
+
+        for (size_t c = 0; c < clusterCount; ++c)
+        {
+            float clusterArea = 0.0f;
+            for (size_t t = clusters[c]; t < clusters[c + 1]; ++t)
+            {
+                const glm::vec3 &a = positions[indices[t * 3]];
+                const glm::vec3 &b = positions[indices[t * 3 + 1]];
+                const glm::vec3 &d = positions[indices[t * 3 + 2]];
+
+                glm::vec3 cross = glm::cross(b - a, d - a);
+                float area = glm::length(cross);
+
+                centroid[c] += (a + b + d) * (area / 3.0f);
+                normal[c] += cross;
+                clusterArea += area;
+            }
+
+            meshCentroid += centroid[c];
+            meshArea += clusterArea;
+            if (clusterArea > 0.0f)
+                centroid[c] /= clusterArea;
+        }
+        if (meshArea > 0.0f)
+            meshCentroid /= meshArea;
+
+        // Clusters facing away from the centre are likely in front: draw them first
+        std::vector<float> key(clusterCount, 0.0f);
+        for (size_t c = 0; c < clusterCount; ++c)
+        {
+            float length = glm::length(normal[c]);
+            if (length > 0.0f)
+                key[c] = glm::dot(centroid[c] - meshCentroid, normal[c] / length);
+        }
+
+        std::vector<size_t> order(clusterCount);
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&key](size_t a, size_t b)
+                         { return key[a] > key[b]; });
+
+        std::vector<uint32_t> out;
+        out.reserve(indices.size());
+        for (size_t c : order)
+            out.insert(out.end(), indices.begin() + clusters[c] * 3, indices.begin() + clusters[c + 1] * 3);
+
+        indices.swap(out);
+    }
+
+    std::vector<uint32_t> OptimizeVertexFetch(std::vector<uint32_t> &indices, size_t vertexCount, size_t &usedVertices)
+    {
+        std::vector<uint32_t> remap(vertexCount, ~0u);
+        uint32_t next = 0;
+        for (uint32_t &index : indices)
+        {
+            if (remap[index] == ~0u)
+                remap[index] = next++;
+            index = remap[index];
+        }
+
+        usedVertices = next;
+        return remap;
+    }
+
+    CacheStats AnalyzeVertexCache(const std::vector<uint32_t> &indices, size_t vertexCount, uint32_t cacheSize)
+    {
+        CacheStats stats;
+        if (indices.size() < 3)
+            return stats;
+
+        FifoCache cache(vertexCount, cacheSize);
+        std::vector<bool> used(vertexCount, false);
+        size_t misses = 0, unique = 0;
+        for (uint32_t index : indices)
+        {
+            misses += cache.Access(index);
+            if (!used[index])
+            {
+                used[index] = true;
+                unique++;
+            }
+        }
+
+        stats.acmr = (float)misses / (float)(indices.size() / 3);
+        stats.atvr = (float)misses / (float)unique;
+        return stats;
+    }
+
+    float AnalyzeOverdraw(const std::vector<uint32_t> &indices, const std::vector<glm::vec3> &positions)
+    {
+        if (indices.size() < 3)
+            return 0.0f;
+
+        glm::vec3 min(std::numeric_limits<float>::max()), max(-std::numeric_limits<float>::max());
+        for (uint32_t index : indices)
+        {
+            min = glm::min(min, positions[index]);
+            max = glm::max(max, positions[index]);
+        }
+        glm::vec3 extent = max - min;
+        float scale = std::max({extent.x, extent.y, extent.z});
+        if (scale <= 0.0f)
+            return 0.0f;
+        scale = (float)(OVERDRAW_GRID - 1) / scale;
+
+        std::vector<glm::vec3> projected(indices.size());
+        std::vector<float> depth((size_t)OVERDRAW_GRID * OVERDRAW_GRID);
+        RasterStats stats;
+
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            // (u, v, depth) keeps a right handed frame looking down -axis
+            int u = (axis + 1) % 3, v = (axis + 2) % 3;
+            for (size_t i = 0; i < indices.size(); ++i)
+            {
+                glm::vec3 p = (positions[indices[i]] - min) * scale;
+                projected[i] = {p[u], p[v], p[axis]};
+            }
+
+            for (int side = 0; side < 2; ++side)
+                RasterizeView(projected, side, depth, stats);
+        }
+
+        return stats.covered ? (float)stats.shaded / (float)stats.covered : 0.0f;
+    }
+}
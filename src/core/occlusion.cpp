@@ -0,0 +1,345 @@
+#include <engine/render/occlusion.hpp>
+#include <engine/threadpool.hpp>
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define OCCLUSION_SSE 1
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+    constexpr float NEAR_EPSILON = 1e-5f;
+
+    // Clips a clip-space triangle against the near plane (z >= -w).
+    // Returns the number of polygon vertices written to out (0, 3 or 4).
+    int ClipNear(const glm::vec4 in[3], glm::vec4 out[4])
+    {
+        int count = 0;
+        for (int i = 0; i < 3; ++i)
+        {
+            const glm::vec4 &a = in[i];
+            const glm::vec4 &b = in[(i + 1) % 3];
+            float da = a.z + a.w;
+            float db = b.z + b.w;
+
+            if (da >= 0.0f)
+                out[count++] = a;
+            if ((da >= 0.0f) != (db >= 0.0f))
+            {
+                float t = da / (da - db);
+                out[count++] = a + (b - a) * t;
+            }
+        }
+        return count;
+    }
+}
+
+OcclusionCuller::OcclusionCuller(int width, int height)
+{
+    Resize(width, height);
+}
+
+void OcclusionCuller::Resize(int w, int h)
+{
+    // Keep the buffer a whole number of tiles so rows stay SIMD aligned.
+    width = std::max(TILE_SIZE, (w + TILE_SIZE - 1) / TILE_SIZE * TILE_SIZE);
+    height = std::max(TILE_SIZE, (h + TILE_SIZE - 1) / TILE_SIZE * TILE_SIZE);
+    stride = width;
+    tilesX = width / TILE_SIZE;
+    tilesY = height / TILE_SIZE;
+
+    depth.assign((size_t)stride * height, 1.0f);
+    hierarchy.assign((size_t)tilesX * tilesY, 1.0f);
+}
+
+void OcclusionCuller::Begin(const glm::mat4 &vp)
+{
+    viewProjection = vp;
+    occluders.clear();
+    stats = Stats{};
+
+    std::fill(depth.begin(), depth.end(), 1.0f);
+    std::fill(hierarchy.begin(), hierarchy.end(), 1.0f);
+}
+
+void OcclusionCuller::AddOccluder(
+    const glm::mat4 &model,
+    const glm::vec3 *positions,
+    size_t vertexCount,
+    const uint32_t *indices,
+    size_t indexCount)
+{
+    if (!positions || !indices || indexCount < 3)
+        return;
+
+    occluders.push_back({model, positions, vertexCount, indices, indexCount});
+    stats.occluderTriangles += indexCount / 3;
+}
+
+void OcclusionCuller::Rasterize()
+{
+    if (occluders.empty())
+        return;
+
+    auto &pool = ThreadPool::Get();
+
+    triangles.resize(occluders.size());
+    pool.ParallelFor(occluders.size(), [this](size_t i)
+                     {
+        triangles[i].clear();
+        TransformOccluder(occluders[i], triangles[i]); });
+
+    for (size_t i = 0; i < occluders.size(); ++i)
+        stats.rasterizedTriangles += triangles[i].size();
+
+    // Bands are whole tile rows so each band can also reduce its own tiles.
+    int bandCount = std::min<int>(tilesY, (int)pool.WorkerCount() + 1);
+    int tileRowsPerBand = (tilesY + bandCount - 1) / bandCount;
+
+    pool.ParallelFor((size_t)bandCount, [this, tileRowsPerBand](size_t band)
+                     {
+        int tileRow0 = (int)band * tileRowsPerBand;
+        int tileRow1 = std::min(tilesY, tileRow0 + tileRowsPerBand);
+        if (tileRow0 >= tileRow1)
+            return;
+
+        RasterizeBand(tileRow0 * TILE_SIZE, tileRow1 * TILE_SIZE);
+        BuildHierarchy(tileRow0, tileRow1); });
+}
+
+void OcclusionCuller::TransformOccluder(const Occluder &occluder, std::vector<ScreenTriangle> &out) const
+{
+    glm::mat4 mvp = viewProjection * occluder.model;
+
+    std::vector<glm::vec4> clip(occluder.vertexCount);
+    for (size_t i = 0; i < occluder.vertexCount; ++i)
+        clip[i] = mvp * glm::vec4(occluder.positions[i], 1.0f);
+
+    const float halfW = width * 0.5f;
+    const float halfH = height * 0.5f;
+
+    auto toScreen = [&](const glm::vec4 &c)
+    {
+        float invW = 1.0f / c.w;
+        return glm::vec3(
+            (c.x * invW + 1.0f) * halfW,
+            (c.y * invW + 1.0f) * halfH,
+            glm::clamp(c.z * invW * 0.5f + 0.5f, 0.0f, 1.0f));
+    };
+
+    out.reserve(occluder.indexCount / 3);
+    for (size_t i = 0; i + 2 < occluder.indexCount; i += 3)
+    {
+        uint32_t i0 = occluder.indices[i];
+        uint32_t i1 = occluder.indices[i + 1];
+        uint32_t i2 = occluder.indices[i + 2];
+        if (i0 >= occluder.vertexCount || i1 >= occluder.vertexCount || i2 >= occluder.vertexCount)
+            continue;
+
+        glm::vec4 in[3] = {clip[i0], clip[i1], clip[i2]};
+        glm::vec4 poly[4];
+        int count;
+
+        if (in[0].z + in[0].w >= 0.0f && in[1].z + in[1].w >= 0.0f && in[2].z + in[2].w >= 0.0f)
+        {
+            poly[0] = in[0];
+            poly[1] = in[1];
+            poly[2] = in[2];
+            count = 3;
+        }
+        else
+        {
+            count = ClipNear(in, poly);
+        }
+
+        for (int t = 1; t + 1 < count; ++t)
+        {
+            if (poly[0].w < NEAR_EPSILON || poly[t].w < NEAR_EPSILON || poly[t + 1].w < NEAR_EPSILON)
+                continue;
+
+            ScreenTriangle tri;
+            tri.v[0] = toScreen(poly[0]);
+            tri.v[1] = toScreen(poly[t]);
+            tri.v[2] = toScreen(poly[t + 1]);
+
+            float minX = std::min({tri.v[0].x, tri.v[1].x, tri.v[2].x});
+            float maxX = std::max({tri.v[0].x, tri.v[1].x, tri.v[2].x});
+            float minY = std::min({tri.v[0].y, tri.v[1].y, tri.v[2].y});
+            float maxY = std::max({tri.v[0].y, tri.v[1].y, tri.v[2].y});
+
+            if (maxX < 0.0f || maxY < 0.0f || minX >= (float)width || minY >= (float)height)
+                continue;
+
+            tri.minY = std::max(0, (int)std::floor(minY));
+            tri.maxY = std::min(height - 1, (int)std::ceil(maxY));
+            out.push_back(tri);
+        }
+    }
+}
+
+void OcclusionCuller::RasterizeBand(int y0, int y1)
+{
+    for (auto &list : triangles)
+        for (auto &tri : list)
+            if (tri.maxY >= y0 && tri.minY < y1)
+                RasterizeTriangle(tri, y0, y1);
+}
+
+void OcclusionCuller::RasterizeTriangle(const ScreenTriangle &tri, int y0, int y1)
+{
+    glm::vec3 a = tri.v[0];
+    glm::vec3 b = tri.v[1];
+    glm::vec3 c = tri.v[2];
+
+    float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+    if (std::fabs(area) < 1e-8f)
+        return;
+    if (area < 0.0f)
+    {
+        std::swap(b, c);
+        area = -area;
+    }
+
+    // Edge functions e(p) = A * px + B * py + C, positive inside.
+    float A0 = b.y - c.y, B0 = c.x - b.x, C0 = b.x * c.y - b.y * c.x; // weight of a
+    float A1 = c.y - a.y, B1 = a.x - c.x, C1 = c.x * a.y - c.y * a.x; // weight of b
+    float A2 = a.y - b.y, B2 = b.x - a.x, C2 = a.x * b.y - a.y * b.x; // weight of c
+
+    // z / w is affine in screen space.
+    float invArea = 1.0f / area;
+    float ZA = (a.z * A0 + b.z * A1 + c.z * A2) * invArea;
+    float ZB = (a.z * B0 + b.z * B1 + c.z * B2) * invArea;
+    float ZC = (a.z * C0 + b.z * C1 + c.z * C2) * invArea;
+
+    int minX = std::max(0, (int)std::floor(std::min({a.x, b.x, c.x})));
+    int maxX = std::min(width - 1, (int)std::ceil(std::max({a.x, b.x, c.x})));
+    int rowStart = std::max(y0, tri.minY);
+    int rowEnd = std::min(y1 - 1, tri.maxY);
+    if (minX > maxX || rowStart > rowEnd)
+        return;
+
+    int xStart = minX & ~3;
+
+    for (int y = rowStart; y <= rowEnd; ++y)
+    {
+        float py = (float)y + 0.5f;
+        float row0 = B0 * py + C0;
+        float row1 = B1 * py + C1;
+        float row2 = B2 * py + C2;
+        float rowZ = ZB * py + ZC;
+        float *dst = depth.data() + (size_t)y * stride;
+
+#ifdef OCCLUSION_SSE
+        const __m128 offsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 vA0 = _mm_set1_ps(A0), vA1 = _mm_set1_ps(A1), vA2 = _mm_set1_ps(A2);
+        const __m128 vR0 = _mm_set1_ps(row0), vR1 = _mm_set1_ps(row1), vR2 = _mm_set1_ps(row2);
+        const __m128 vZA = _mm_set1_ps(ZA), vRZ = _mm_set1_ps(rowZ);
+
+        for (int x = xStart; x <= maxX; x += 4)
+        {
+            __m128 px = _mm_add_ps(_mm_set1_ps((float)x), offsets);
+
+            __m128 e0 = _mm_add_ps(_mm_mul_ps(vA0, px), vR0);
+            __m128 e1 = _mm_add_ps(_mm_mul_ps(vA1, px), vR1);
+            __m128 e2 = _mm_add_ps(_mm_mul_ps(vA2, px), vR2);
+
+            __m128 inside = _mm_and_ps(
+                _mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_cmpge_ps(e1, zero)),
+                _mm_cmpge_ps(e2, zero));
+            if (_mm_movemask_ps(inside) == 0)
+                continue;
+
+            __m128 z = _mm_add_ps(_mm_mul_ps(vZA, px), vRZ);
+            z = _mm_min_ps(_mm_max_ps(z, zero), one);
+
+            __m128 current = _mm_loadu_ps(dst + x);
+            __m128 nearest = _mm_min_ps(current, z);
+            __m128 result = _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, current));
+            _mm_storeu_ps(dst + x, result);
+        }
+#else
+        for (int x = xStart; x <= maxX; ++x)
+        {
+            float px = (float)x + 0.5f;
+            if (A0 * px + row0 < 0.0f || A1 * px + row1 < 0.0f || A2 * px + row2 < 0.0f)
+                continue;
+
+            float z = glm::clamp(ZA * px + rowZ, 0.0f, 1.0f);
+            dst[x] = std::min(dst[x], z);
+        }
+#endif
+    }
+}
+
+void OcclusionCuller::BuildHierarchy(int tileRow0, int tileRow1)
+{
+    for (int ty = tileRow0; ty < tileRow1; ++ty)
+    {
+        for (int tx = 0; tx < tilesX; ++tx)
+        {
+            float farthest = 0.0f;
+            for (int y = 0; y < TILE_SIZE; ++y)
+            {
+                const float *row = depth.data() + (size_t)(ty * TILE_SIZE + y) * stride + tx * TILE_SIZE;
+                for (int x = 0; x < TILE_SIZE; ++x)
+                    farthest = std::max(farthest, row[x]);
+            }
+            hierarchy[(size_t)ty * tilesX + tx] = farthest;
+        }
+    }
+}
+
+bool OcclusionCuller::IsVisible(const AABB &localBounds, const glm::mat4 &model)
+{
+    if (!localBounds.IsValid())
+        return true;
+
+    stats.tested++;
+
+    glm::mat4 mvp = viewProjection * model;
+
+    glm::vec3 ndcMin(FLT_MAX);
+    glm::vec3 ndcMax(-FLT_MAX);
+    for (int i = 0; i < 8; ++i)
+    {
+        glm::vec4 c = mvp * glm::vec4(localBounds.Corner(i), 1.0f);
+
+        // Crossing the near plane, can't be bounded on screen.
+        if (c.w <= NEAR_EPSILON)
+            return true;
+
+        glm::vec3 ndc = glm::vec3(c) / c.w;
+        ndcMin = glm::min(ndcMin, ndc);
+        ndcMax = glm::max(ndcMax, ndc);
+    }
+
+    if (ndcMax.x < -1.0f || ndcMin.x > 1.0f ||
+        ndcMax.y < -1.0f || ndcMin.y > 1.0f ||
+        ndcMin.z > 1.0f)
+    {
+        stats.culled++;
+        return false;
+    }
+
+    if (occluders.empty())
+        return true;
+
+    float nearest = ndcMin.z * 0.5f + 0.5f;
+
+    int tx0 = glm::clamp((int)std::floor((ndcMin.x * 0.5f + 0.5f) * width) / TILE_SIZE, 0, tilesX - 1);
+    int tx1 = glm::clamp((int)std::floor((ndcMax.x * 0.5f + 0.5f) * width) / TILE_SIZE, 0, tilesX - 1);
+    int ty0 = glm::clamp((int)std::floor((ndcMin.y * 0.5f + 0.5f) * height) / TILE_SIZE, 0, tilesY - 1);
+    int ty1 = glm::clamp((int)std::floor((ndcMax.y * 0.5f + 0.5f) * height) / TILE_SIZE, 0, tilesY - 1);
+
+    for (int ty = ty0; ty <= ty1; ++ty)
+        for (int tx = tx0; tx <= tx1; ++tx)
+            if (nearest <= hierarchy[(size_t)ty * tilesX + tx])
+                return true;
+
+    stats.culled++;
+    return false;
+}
@@ -0,0 +1,13 @@
+#include <engine/systems/physics.hpp>
+
+void Collider::OnAttach()
+{
+    if (auto en = entity.lock())
+        PhysicsSystem::Get().Enqueue(en);
+}
+
+void RigidBody3D::OnAttach()
+{
+    if (auto en = entity.lock())
+        PhysicsSystem::Get().Enqueue(en);
+}
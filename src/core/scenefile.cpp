@@ -0,0 +1,555 @@
+#include <engine/scenefile.hpp>
+#include <engine/scene.hpp>
+#include <engine/modelasset.hpp>
+#include <engine/components/camera.hpp>
+#include <engine/components/light.hpp>
+#include <engine/components/looker.hpp>
+#include <engine/components/occluder.hpp>
+#include <engine/components/meshfilter.hpp>
+#include <engine/components/meshrenderer.hpp>
+#include <engine/components/physics/rigidbody3d.hpp>
+#include <engine/components/physics/collider/boxcollider3d.hpp>
+#include <engine/components/physics/collider/spherecollider3d.hpp>
+#include <engine/components/physics/collider/capsulecollider3d.hpp>
+#include <engine/components/physics/collider/meshcollider3d.hpp>
+#include <engine/components/ui/canvas.hpp>
+#include <engine/components/ui/image.hpp>
+#include <engine/filesystem.hpp>
+#include <engine/tracer.hpp>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+// <windows.h> defines near and far, which Camera uses; Win32 code belongs in
+// .cpp files (see mappedfile.cpp), never in headers reached from here.
+#if defined(near) || defined(far)
+#error "near/far are macros: a header included above pulled in <windows.h>"
+#endif
+
+using namespace SceneFormat;
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    // Record types in table order, for strides and validation.
+    constexpr uint32_t STRIDES[TABLE_COUNT] = {
+        sizeof(Asset),
+        sizeof(SceneFormat::Mesh),
+        sizeof(SceneFormat::Camera),
+        sizeof(SceneFormat::Light),
+        sizeof(BoxCollider),
+        sizeof(SphereCollider),
+        sizeof(CapsuleCollider),
+        sizeof(Marker),
+        sizeof(RigidBody),
+        sizeof(SceneFormat::Looker),
+        sizeof(Marker),
+        sizeof(Marker),
+        sizeof(SceneFormat::Image),
+    };
+
+    void Store(float *out, const glm::vec3 &v)
+    {
+        out[0] = v.x;
+        out[1] = v.y;
+        out[2] = v.z;
+    }
+
+    glm::vec3 Load3(const float *in)
+    {
+        return {in[0], in[1], in[2]};
+    }
+
+    // Tables as they are gathered, before being laid out into the file.
+    struct Builder
+    {
+        std::vector<SceneFormat::Entity> entities;
+        std::vector<uint8_t> tables[TABLE_COUNT];
+        uint32_t counts[TABLE_COUNT] = {};
+        std::string strings;
+
+        template <typename T>
+        T &Add(Table table)
+        {
+            auto &bytes = tables[table];
+            bytes.resize(bytes.size() + sizeof(T));
+            counts[table]++;
+            return *reinterpret_cast<T *>(bytes.data() + bytes.size() - sizeof(T));
+        }
+
+        void String(const std::string &text, uint32_t &offset, uint32_t &length)
+        {
+            offset = (uint32_t)strings.size();
+            length = (uint32_t)text.size();
+            strings += text;
+        }
+
+        std::vector<uint8_t> Serialize() const
+        {
+            std::vector<uint8_t> bytes(sizeof(Header));
+            auto append = [&bytes](const void *data, size_t size)
+            {
+                uint64_t offset = (bytes.size() + 7) & ~uint64_t(7);
+                bytes.resize(offset + size);
+                if (size)
+                    std::memcpy(bytes.data() + offset, data, size);
+                return offset;
+            };
+
+            Header header{};
+            std::memcpy(header.magic, MAGIC, 4);
+            header.version = VERSION;
+            header.entityCount = (uint32_t)entities.size();
+            header.entitiesOffset = append(entities.data(), entities.size() * sizeof(SceneFormat::Entity));
+            for (uint32_t t = 0; t < TABLE_COUNT; ++t)
+                header.tables[t] = {counts[t], STRIDES[t], append(tables[t].data(), tables[t].size())};
+            header.stringsOffset = append(strings.data(), strings.size());
+            header.stringsSize = strings.size();
+            header.fileSize = bytes.size();
+
+            std::memcpy(bytes.data(), &header, sizeof(header));
+            return bytes;
+        }
+    };
+
+    // Bounds-checked view of a mapped .oscn image.
+    class Reader
+    {
+    public:
+        Reader(const uint8_t *data, size_t size) : data(data), size(size) {}
+
+        const Header &GetHeader() const { return *reinterpret_cast<const Header *>(data); }
+
+        template <typename T>
+        const T *Records(Table table) const
+        {
+            return reinterpret_cast<const T *>(data + GetHeader().tables[table].offset);
+        }
+
+        uint32_t Count(Table table) const { return GetHeader().tables[table].count; }
+
+        const SceneFormat::Entity &GetEntity(uint32_t i) const
+        {
+            return reinterpret_cast<const SceneFormat::Entity *>(data + GetHeader().entitiesOffset)[i];
+        }
+
+        std::string GetString(uint32_t offset, uint32_t length) const
+        {
+            return std::string(reinterpret_cast<const char *>(data + GetHeader().stringsOffset + offset), length);
+        }
+
+        bool Validate() const
+        {
+            if (size < sizeof(Header))
+                return false;
+
+            const Header &h = GetHeader();
+            if (std::memcmp(h.magic, MAGIC, 4) != 0 || h.version != VERSION || h.fileSize != size)
+                return false;
+            if (!InRange(h.entitiesOffset, (uint64_t)h.entityCount * sizeof(SceneFormat::Entity)) ||
+                !InRange(h.stringsOffset, h.stringsSize))
+                return false;
+
+            for (uint32_t i = 0; i < h.entityCount; ++i)
+            {
+                const auto &e = GetEntity(i);
+                if (e.parent >= (int32_t)i || !InStrings(e.nameOffset, e.nameLength))
+                    return false;
+            }
+
+            for (uint32_t t = 0; t < TABLE_COUNT; ++t)
+            {
+                const TableRange &range = h.tables[t];
+                if (range.stride != STRIDES[t] || !InRange(range.offset, (uint64_t)range.count * range.stride))
+                    return false;
+
+                // Every component record starts with its entity index
+                if (t != ASSETS)
+                    for (uint32_t i = 0; i < range.count; ++i)
+                    {
+                        uint32_t entity;
+                        std::memcpy(&entity, data + range.offset + (uint64_t)i * range.stride, sizeof(entity));
+                        if (entity >= h.entityCount)
+                            return false;
+                    }
+            }
+
+            for (uint32_t i = 0; i < Count(ASSETS); ++i)
+                if (!InStrings(Records<Asset>(ASSETS)[i].pathOffset, Records<Asset>(ASSETS)[i].pathLength))
+                    return false;
+            for (uint32_t i = 0; i < Count(MESHES); ++i)
+                if (Records<SceneFormat::Mesh>(MESHES)[i].asset >= Count(ASSETS))
+                    return false;
+            for (uint32_t i = 0; i < Count(IMAGES); ++i)
+                if (!InStrings(Records<SceneFormat::Image>(IMAGES)[i].pathOffset, Records<SceneFormat::Image>(IMAGES)[i].pathLength))
+                    return false;
+            return true;
+        }
+
+    private:
+        bool InRange(uint64_t offset, uint64_t bytes) const
+        {
+            return offset <= size && bytes <= size - offset;
+        }
+
+        bool InStrings(uint32_t offset, uint32_t length) const
+        {
+            return (uint64_t)offset + length <= GetHeader().stringsSize;
+        }
+
+        const uint8_t *data;
+        size_t size;
+    };
+
+    bool WriteFile(const std::string &path, const std::vector<uint8_t> &bytes)
+    {
+        std::error_code ec;
+        auto parent = std::filesystem::path(path).parent_path();
+        if (!parent.empty())
+            std::filesystem::create_directories(parent, ec);
+
+        std::string temp = path + ".tmp";
+        {
+            std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+            if (!out)
+                return false;
+            out.write(reinterpret_cast<const char *>(bytes.data()), (std::streamsize)bytes.size());
+            if (!out)
+                return false;
+        }
+
+        std::filesystem::rename(temp, path, ec);
+        if (ec)
+        {
+            std::filesystem::remove(temp, ec);
+            return false;
+        }
+        return true;
+    }
+}
+
+bool SceneSerializer::Save(const Scene &scene, const std::string &path, Stats *stats)
+{
+    TRACE_SCOPE("Scene save", path);
+    auto start = Clock::now();
+
+    Builder out;
+    Stats result;
+
+    // Meshes are stored as (model, index) so loading goes back through ModelRegistry
+    struct MeshSource
+    {
+        const std::string *path;
+        MeshResidency residency;
+        uint32_t index;
+    };
+    std::unordered_map<const ::Mesh *, MeshSource> sources;
+    ModelRegistry::Get().ForEach([&sources](const std::string &modelPath, const ModelAsset &asset)
+                                 {
+        const auto &meshes = asset.GetMeshes();
+        for (uint32_t i = 0; i < meshes.size(); ++i)
+            sources[meshes[i].get()] = {&modelPath, asset.GetResidency(), i}; });
+    std::unordered_map<const std::string *, uint32_t> assetIndex;
+
+    // Depth first so a parent always precedes its children
+    std::vector<std::pair<std::shared_ptr<::Entity>, int32_t>> stack;
+    const auto &roots = scene.GetEntities();
+    for (auto it = roots.rbegin(); it != roots.rend(); ++it)
+        stack.push_back({*it, -1});
+
+    while (!stack.empty())
+    {
+        auto [entity, parent] = std::move(stack.back());
+        stack.pop_back();
+
+        uint32_t index = (uint32_t)out.entities.size();
+        SceneFormat::Entity record{};
+        record.parent = parent;
+        out.String(entity->name, record.nameOffset, record.nameLength);
+        Store(record.position, entity->transform.position);
+        const glm::quat &q = entity->transform.rotation;
+        record.rotation[0] = q.w;
+        record.rotation[1] = q.x;
+        record.rotation[2] = q.y;
+        record.rotation[3] = q.z;
+        Store(record.scale, entity->transform.scale);
+        out.entities.push_back(record);
+
+        // A MeshRenderer belongs to the MeshFilter added just before it
+        SceneFormat::Mesh *lastMesh = nullptr;
+        for (auto &component : entity->GetAllComponents())
+        {
+            Component *c = component.get();
+
+            if (auto filter = dynamic_cast<MeshFilter *>(c))
+            {
+                auto source = sources.find(filter->mesh.get());
+                if (source == sources.end())
+                {
+                    lastMesh = nullptr;
+                    result.skipped++;
+                    continue;
+                }
+
+                auto asset = assetIndex.emplace(source->second.path, out.counts[ASSETS]);
+                if (asset.second)
+                {
+                    auto &a = out.Add<Asset>(ASSETS);
+                    out.String(*source->second.path, a.pathOffset, a.pathLength);
+                    a.residency = (uint32_t)source->second.residency;
+                }
+
+                lastMesh = &out.Add<SceneFormat::Mesh>(MESHES);
+                *lastMesh = {index, asset.first->second, source->second.index, 0};
+            }
+            else if (auto renderer = dynamic_cast<MeshRenderer *>(c))
+            {
+                if (!lastMesh || (lastMesh->flags & MESH_RENDERER))
+                {
+                    result.skipped++;
+                    continue;
+                }
+                result.components++;
+                lastMesh->flags = MESH_RENDERER |
+                                  (renderer->lit ? (uint32_t)MESH_LIT : 0u) |
+                                  (renderer->castShadows ? (uint32_t)MESH_CAST_SHADOWS : 0u) |
+                                  (renderer->receiveShadows ? (uint32_t)MESH_RECEIVE_SHADOWS : 0u);
+            }
+            else if (auto camera = dynamic_cast<::Camera *>(c))
+                out.Add<SceneFormat::Camera>(CAMERAS) = {index, camera->fov, camera->near, camera->far};
+            else if (auto light = dynamic_cast<::Light *>(c))
+            {
+                auto &l = out.Add<SceneFormat::Light>(LIGHTS);
+                l.entity = index;
+                l.type = (uint32_t)light->type;
+                Store(l.color, light->color);
+                l.intensity = light->intensity;
+                Store(l.direction, light->direction);
+                l.range = light->range;
+            }
+            else if (auto box = dynamic_cast<BoxCollider3D *>(c))
+            {
+                auto &b = out.Add<BoxCollider>(BOX_COLLIDERS);
+                b.entity = index;
+                Store(b.halfSize, box->halfSize);
+            }
+            else if (auto sphere = dynamic_cast<SphereCollider3D *>(c))
+                out.Add<SphereCollider>(SPHERE_COLLIDERS) = {index, sphere->radius};
+            else if (auto capsule = dynamic_cast<CapsuleCollider3D *>(c))
+                out.Add<CapsuleCollider>(CAPSULE_COLLIDERS) = {index, capsule->radius, capsule->height};
+            else if (dynamic_cast<MeshCollider3D *>(c))
+                out.Add<Marker>(MESH_COLLIDERS) = {index};
+            else if (auto body = dynamic_cast<RigidBody3D *>(c))
+            {
+                uint32_t flags = (body->useGravity ? (uint32_t)BODY_GRAVITY : 0u) | (body->isKinematic ? (uint32_t)BODY_KINEMATIC : 0u);
+                const bool freeze[6] = {body->freezePositionX, body->freezePositionY, body->freezePositionZ,
+                                        body->freezeRotationX, body->freezeRotationY, body->freezeRotationZ};
+                for (uint32_t i = 0; i < 6; ++i)
+                    if (freeze[i])
+                        flags |= BODY_FREEZE_POSITION_X << i;
+                if (body->interpolation == RigidbodyInterpolation::None)
+                    flags |= BODY_NO_INTERPOLATION;
+                out.Add<RigidBody>(RIGIDBODIES) = {index, body->mass, flags};
+            }
+            else if (auto looker = dynamic_cast<::Looker *>(c))
+                out.Add<SceneFormat::Looker>(LOOKERS) = {index, looker->sensitivity, looker->speed};
+            else if (dynamic_cast<Occluder *>(c))
+                out.Add<Marker>(OCCLUDERS) = {index};
+            else if (dynamic_cast<Canvas *>(c))
+                out.Add<Marker>(CANVASES) = {index};
+            else if (auto image = dynamic_cast<::Image *>(c))
+            {
+                auto &i = out.Add<SceneFormat::Image>(IMAGES);
+                i.entity = index;
+                out.String(image->GetPath(), i.pathOffset, i.pathLength);
+                i.position[0] = image->position.x;
+                i.position[1] = image->position.y;
+                i.size[0] = image->size.x;
+                i.size[1] = image->size.y;
+            }
+            else
+            {
+                // Runtime state such as PhysicsComponent is rebuilt by PhysicsSystem
+                if (!dynamic_cast<PhysicsComponent *>(c))
+                    result.skipped++;
+            }
+        }
+
+        auto children = entity->GetChildren();
+        for (auto it = children.rbegin(); it != children.rend(); ++it)
+            stack.push_back({*it, (int32_t)index});
+    }
+
+    std::vector<uint8_t> bytes = out.Serialize();
+    bool written = WriteFile(path, bytes);
+
+    for (uint32_t t = MESHES; t < TABLE_COUNT; ++t)
+        result.components += out.counts[t];
+    result.entities = out.entities.size();
+    result.assets = out.counts[ASSETS];
+    result.bytes = bytes.size();
+    result.milliseconds = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    if (stats)
+        *stats = result;
+    return written;
+}
+
+SceneSerializer::Stats SceneSerializer::Load(const std::string &path, const std::shared_ptr<Scene> &scene)
+{
+    TRACE_SCOPE("Scene load", path);
+    auto start = Clock::now();
+
+    FileView file = FileSystem::Get().Open(path);
+    if (!file.IsOpen())
+        throw std::runtime_error("Failed to open scene: " + path);
+
+    Reader in(file.Data(), file.Size());
+    if (!in.Validate())
+        throw std::runtime_error("Invalid scene file: " + path);
+
+    const Header &header = in.GetHeader();
+    Stats stats;
+    stats.entities = header.entityCount;
+    stats.assets = in.Count(ASSETS);
+    stats.bytes = file.Size();
+
+    // Models first, so a bad mesh reference fails before any entity exists
+    std::vector<std::shared_ptr<const ModelAsset>> assets;
+    assets.reserve(in.Count(ASSETS));
+    for (uint32_t i = 0; i < in.Count(ASSETS); ++i)
+    {
+        const Asset &a = in.Records<Asset>(ASSETS)[i];
+        assets.push_back(ModelRegistry::Get().Load(in.GetString(a.pathOffset, a.pathLength), (MeshResidency)a.residency));
+    }
+    for (uint32_t i = 0; i < in.Count(MESHES); ++i)
+    {
+        const SceneFormat::Mesh &m = in.Records<SceneFormat::Mesh>(MESHES)[i];
+        if (m.mesh >= assets[m.asset]->GetMeshes().size())
+            throw std::runtime_error("Scene references a missing mesh: " + path);
+    }
+
+    std::vector<std::shared_ptr<::Entity>> entities(header.entityCount);
+    std::vector<std::shared_ptr<::Entity>> roots;
+    for (uint32_t i = 0; i < header.entityCount; ++i)
+    {
+        const SceneFormat::Entity &e = in.GetEntity(i);
+        auto entity = std::make_shared<::Entity>(in.GetString(e.nameOffset, e.nameLength));
+        entity->scene = scene;
+        entity->transform.position = Load3(e.position);
+        entity->transform.rotation = glm::quat(e.rotation[0], e.rotation[1], e.rotation[2], e.rotation[3]);
+        entity->transform.scale = Load3(e.scale);
+
+        if (e.parent < 0)
+            roots.push_back(entity);
+        else
+            entities[e.parent]->AddChild(entity);
+        entities[i] = std::move(entity);
+    }
+
+    // Tables in dependency order: mesh colliders need the MeshFilter, occluders
+    // gather the meshes of their whole subtree.
+    for (uint32_t i = 0; i < in.Count(MESHES); ++i)
+    {
+        const SceneFormat::Mesh &m = in.Records<SceneFormat::Mesh>(MESHES)[i];
+        auto &entity = entities[m.entity];
+        entity->AddComponent<MeshFilter>(assets[m.asset]->GetMeshes()[m.mesh]);
+        if (m.flags & MESH_RENDERER)
+        {
+            auto renderer = entity->AddComponent<MeshRenderer>();
+            renderer->lit = (m.flags & MESH_LIT) != 0;
+            renderer->castShadows = (m.flags & MESH_CAST_SHADOWS) != 0;
+            renderer->receiveShadows = (m.flags & MESH_RECEIVE_SHADOWS) != 0;
+            stats.components++;
+        }
+    }
+
+    for (uint32_t i = 0; i < in.Count(MESH_COLLIDERS); ++i)
+        entities[in.Records<Marker>(MESH_COLLIDERS)[i].entity]->AddComponent<MeshCollider3D>();
+
+    for (uint32_t i = 0; i < in.Count(BOX_COLLIDERS); ++i)
+    {
+        const BoxCollider &b = in.Records<BoxCollider>(BOX_COLLIDERS)[i];
+        entities[b.entity]->AddComponent<BoxCollider3D>()->halfSize = Load3(b.halfSize);
+    }
+
+    for (uint32_t i = 0; i < in.Count(SPHERE_COLLIDERS); ++i)
+    {
+        const SphereCollider &s = in.Records<SphereCollider>(SPHERE_COLLIDERS)[i];
+        entities[s.entity]->AddComponent<SphereCollider3D>()->radius = s.radius;
+    }
+
+    for (uint32_t i = 0; i < in.Count(CAPSULE_COLLIDERS); ++i)
+    {
+        const CapsuleCollider &c = in.Records<CapsuleCollider>(CAPSULE_COLLIDERS)[i];
+        auto capsule = entities[c.entity]->AddComponent<CapsuleCollider3D>();
+        capsule->radius = c.radius;
+        capsule->height = c.height;
+    }
+
+    for (uint32_t i = 0; i < in.Count(RIGIDBODIES); ++i)
+    {
+        const RigidBody &r = in.Records<RigidBody>(RIGIDBODIES)[i];
+        auto body = entities[r.entity]->AddComponent<RigidBody3D>(r.mass);
+        body->useGravity = (r.flags & BODY_GRAVITY) != 0;
+        body->isKinematic = (r.flags & BODY_KINEMATIC) != 0;
+        bool *freeze[6] = {&body->freezePositionX, &body->freezePositionY, &body->freezePositionZ,
+                           &body->freezeRotationX, &body->freezeRotationY, &body->freezeRotationZ};
+        for (uint32_t f = 0; f < 6; ++f)
+            *freeze[f] = (r.flags & (BODY_FREEZE_POSITION_X << f)) != 0;
+        if (r.flags & BODY_NO_INTERPOLATION)
+            body->interpolation = RigidbodyInterpolation::None;
+    }
+
+    for (uint32_t i = 0; i < in.Count(CAMERAS); ++i)
+    {
+        const SceneFormat::Camera &c = in.Records<SceneFormat::Camera>(CAMERAS)[i];
+        auto camera = entities[c.entity]->AddComponent<::Camera>(scene->GetWidth(), scene->GetHeight());
+        camera->fov = c.fov;
+        camera->near = c.nearPlane;
+        camera->far = c.farPlane;
+    }
+
+    for (uint32_t i = 0; i < in.Count(LIGHTS); ++i)
+    {
+        const SceneFormat::Light &l = in.Records<SceneFormat::Light>(LIGHTS)[i];
+        auto light = entities[l.entity]->AddComponent<::Light>();
+        light->type = (LightType)l.type;
+        light->color = Load3(l.color);
+        light->intensity = l.intensity;
+        light->direction = Load3(l.direction);
+        light->range = l.range;
+    }
+
+    for (uint32_t i = 0; i < in.Count(LOOKERS); ++i)
+    {
+        const SceneFormat::Looker &l = in.Records<SceneFormat::Looker>(LOOKERS)[i];
+        entities[l.entity]->AddComponent<::Looker>(l.sensitivity, l.speed);
+    }
+
+    for (uint32_t i = 0; i < in.Count(CANVASES); ++i)
+        entities[in.Records<Marker>(CANVASES)[i].entity]->AddComponent<Canvas>(scene->GetWidth(), scene->GetHeight());
+
+    for (uint32_t i = 0; i < in.Count(IMAGES); ++i)
+    {
+        const SceneFormat::Image &img = in.Records<SceneFormat::Image>(IMAGES)[i];
+        auto image = entities[img.entity]->AddComponent<::Image>(in.GetString(img.pathOffset, img.pathLength));
+        image->position = {img.position[0], img.position[1]};
+        image->size = {img.size[0], img.size[1]};
+    }
+
+    for (uint32_t i = 0; i < in.Count(OCCLUDERS); ++i)
+        entities[in.Records<Marker>(OCCLUDERS)[i].entity]->AddComponent<Occluder>();
+
+    for (uint32_t t = MESHES; t < TABLE_COUNT; ++t)
+        stats.components += in.Count((Table)t);
+
+    scene->AddEntities(roots);
+
+    stats.milliseconds = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    return stats;
+}
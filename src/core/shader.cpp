@@ -1,53 +1,83 @@
 #include <engine/shader.hpp>
-#include <fstream>
+#include <engine/shadercache.hpp>
+#include <engine/filesystem.hpp>
+#include <engine/tracer.hpp>
+#include <algorithm>
+#include <filesystem>
+#include <string_view>
 #include <stdexcept>
 #include <unordered_map>
 
-// ---------------- Constructors ----------------
-
-Shader::Shader(const std::string &filepath)
+namespace
 {
-    std::string vertex, fragment;
+    // Splits text into lines without their line ending; calls fn(line, rawLine).
+    template <typename Fn>
+    void ForEachLine(const std::string &text, Fn &&fn)
+    {
+        size_t pos = 0;
+        while (pos < text.size())
+        {
+            size_t end = text.find('\n', pos);
+            size_t next = end == std::string::npos ? text.size() : end + 1;
 
-    std::ifstream file(filepath);
-    if (!file.is_open())
-        throw std::runtime_error("Failed to read file: " + filepath);
+            size_t length = (end == std::string::npos ? text.size() : end) - pos;
+            if (length && text[pos + length - 1] == '\r')
+                length--;
 
-    std::string line;
-    enum class ShaderType
-    {
-        NONE,
-        VERTEX,
-        FRAGMENT
-    };
-    ShaderType type = ShaderType::NONE;
+            fn(std::string_view(text.data() + pos, length), std::string_view(text.data() + pos, next - pos));
+            pos = next;
+        }
+    }
 
-    while (std::getline(file, line))
+    std::string ExpandIncludes(const std::string &filepath, std::vector<std::string> &included)
     {
-        if (line == "#shader vertex")
-            type = ShaderType::VERTEX;
-        else if (line == "#shader fragment")
-            type = ShaderType::FRAGMENT;
-        else
-        {
-            if (type == ShaderType::VERTEX)
-                vertex += line + "\n";
-            else if (type == ShaderType::FRAGMENT)
-                fragment += line + "\n";
-        }
+        std::string text = Shader::ReadFile(filepath);
+        std::filesystem::path directory = std::filesystem::path(filepath).parent_path();
+
+        std::string out;
+        out.reserve(text.size());
+        ForEachLine(text, [&](std::string_view line, std::string_view raw)
+                    {
+            size_t start = line.find_first_not_of(" \t");
+            if (start == std::string_view::npos || line.compare(start, 8, "#include") != 0)
+            {
+                out.append(raw);
+                return;
+            }
+
+            size_t open = line.find('"', start + 8);
+            size_t close = open == std::string_view::npos ? open : line.find('"', open + 1);
+            if (close == std::string_view::npos)
+                throw std::runtime_error("Malformed #include in " + filepath + ": " + std::string(line));
+
+            std::string target = (directory / std::string(line.substr(open + 1, close - open - 1))).lexically_normal().generic_string();
+            if (std::find(included.begin(), included.end(), target) != included.end())
+                return;
+            included.push_back(target);
+
+            out += ExpandIncludes(target, included);
+            if (!out.empty() && out.back() != '\n')
+                out += '\n'; });
+
+        return out;
     }
+}
 
-    vertexShader = Compile(GL_VERTEX_SHADER, vertex);
-    fragmentShader = Compile(GL_FRAGMENT_SHADER, fragment);
+// ---------------- Constructors ----------------
 
-    LinkProgram();
+Shader::Shader(const std::string &filepath)
+{
+    Build(ReadSource(filepath));
 }
 
 Shader::Shader(const std::string &vertexPath, const std::string &fragmentPath)
 {
-    vertexShader = Compile(GL_VERTEX_SHADER, ReadFile(vertexPath));
-    fragmentShader = Compile(GL_FRAGMENT_SHADER, ReadFile(fragmentPath));
-    LinkProgram();
+    Build({ReadWithIncludes(vertexPath), ReadWithIncludes(fragmentPath)});
+}
+
+Shader::Shader(const Source &source)
+{
+    Build(source);
 }
 
 // ---------------- Destructor ----------------
@@ -64,10 +94,93 @@ void Shader::Use() const
     glUseProgram(ID);
 }
 
+Shader::Source Shader::ReadSource(const std::string &filepath)
+{
+    // Includes are expanded first, so the program binary cache key covers them
+    std::string text = ReadWithIncludes(filepath);
+
+    Source source;
+    std::string *current = nullptr;
+
+    ForEachLine(text, [&](std::string_view line, std::string_view raw)
+                {
+        if (line == "#shader vertex")
+            current = &source.vertex;
+        else if (line == "#shader fragment")
+            current = &source.fragment;
+        else if (current)
+            current->append(raw); });
+
+    return source;
+}
+
+Shader::Source Shader::WithDefines(const Source &source, const std::vector<std::string> &defines)
+{
+    std::string block;
+    for (auto &define : defines)
+        block += "#define " + define + "\n";
+
+    auto inject = [&block](std::string stage)
+    {
+        // #version has to stay the first statement
+        size_t version = stage.find("#version");
+        size_t at = 0;
+        if (version != std::string::npos)
+        {
+            size_t end = stage.find('\n', version);
+            at = end == std::string::npos ? stage.size() : end + 1;
+        }
+        stage.insert(at, block);
+        return stage;
+    };
+
+    return {inject(source.vertex), inject(source.fragment)};
+}
+
+std::string Shader::ReadWithIncludes(const std::string &filepath)
+{
+    std::vector<std::string> included{std::filesystem::path(filepath).lexically_normal().generic_string()};
+    return ExpandIncludes(filepath, included);
+}
+
+std::string Shader::ReadFile(const std::string &filepath)
+{
+    FileView file = FileSystem::Get().Open(filepath);
+    if (!file.IsOpen())
+        throw std::runtime_error("Failed to read file: " + filepath);
+
+    return file.ToString();
+}
+
 // ---------------- Private ----------------
 
+void Shader::Build(const Source &source)
+{
+    ShaderCache &cache = ShaderCache::Get();
+    uint64_t hash = ShaderCache::Hash(source);
+
+    ID = glCreateProgram();
+    {
+        TRACE_SCOPE("Shader binary load");
+        if (cache.LoadBinary(hash, ID))
+            return;
+    }
+
+    // Stale or missing binary: start over with a clean program object
+    glDeleteProgram(ID);
+    ID = glCreateProgram();
+
+    vertexShader = Compile(GL_VERTEX_SHADER, source.vertex);
+    fragmentShader = Compile(GL_FRAGMENT_SHADER, source.fragment);
+
+    cache.PrepareBinary(ID);
+    LinkProgram();
+    cache.OnCompiled(hash, ID);
+}
+
 GLuint Shader::Compile(GLenum type, const std::string &source)
 {
+    TRACE_SCOPE("Shader compile", type == GL_VERTEX_SHADER ? "vertex" : "fragment");
     GLuint shader = glCreateShader(type);
     const char *src = source.c_str();
     glShaderSource(shader, 1, &src, nullptr);
@@ -79,7 +192,7 @@ GLuint Shader::Compile(GLenum type, const std::string &source)
 
 void Shader::LinkProgram()
 {
-    ID = glCreateProgram();
+    TRACE_SCOPE("Shader link");
     glAttachShader(ID, vertexShader);
     glAttachShader(ID, fragmentShader);
     glLinkProgram(ID);
@@ -113,19 +226,6 @@ void Shader::CheckProgramLink(GLuint program)
     }
 }
 
-std::string Shader::ReadFile(const std::string &filepath)
-{
-    std::ifstream file(filepath);
-    if (!file.is_open())
-        throw std::runtime_error("Failed to read file: " + filepath);
-
-    std::string content, line;
-    while (std::getline(file, line))
-        content += line + "\n";
-
-    return content;
-}
-
 unsigned int Shader::GetUniformLocation(const std::string &name) const
 {
     auto it = m_UniformCache.find(name);
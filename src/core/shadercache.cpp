@@ -0,0 +1,200 @@
+#include <engine/shadercache.hpp>
+#include <engine/configure.hpp>
+#include <engine/glext.hpp>
+#include <engine/hash.hpp>
+#include <engine/filesystem.hpp>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    constexpr char BINARY_MAGIC[4] = {'O', 'S', 'H', 'B'};
+    constexpr uint32_t BINARY_VERSION = 1;
+
+    // File layout: header, driver string, program binary.
+    struct BinaryHeader
+    {
+        char magic[4];
+        uint32_t version;
+        uint64_t sourceHash;
+        uint32_t format;
+        uint32_t driverLength;
+        uint32_t binaryLength;
+    };
+}
+
+std::shared_ptr<Shader> ShaderCache::Load(const std::string &filepath)
+{
+    return Load(Shader::ReadSource(filepath));
+}
+
+std::shared_ptr<Shader> ShaderCache::Load(const Shader::Source &source)
+{
+    uint64_t hash = Hash(source);
+
+    auto it = programs.find(hash);
+    if (it != programs.end())
+    {
+        if (auto shader = it->second.lock())
+        {
+            stats.memoryHits++;
+            return shader;
+        }
+    }
+
+    auto shader = std::make_shared<Shader>(source);
+    programs[hash] = shader;
+    return shader;
+}
+
+uint64_t ShaderCache::Hash(const Shader::Source &source)
+{
+    // The separator keeps "ab"+"c" and "a"+"bc" apart.
+    uint64_t hash = ::Hash::Fnv1a(source.vertex);
+    hash = ::Hash::Fnv1a("\0", 1, hash);
+    return ::Hash::Fnv1a(source.fragment, hash);
+}
+
+bool ShaderCache::LoadBinary(uint64_t hash, unsigned int program)
+{
+    if (!UseBinaries())
+        return false;
+
+    std::string path = BinaryPath(hash);
+    std::error_code ec;
+    uint64_t fileSize = (uint64_t)fs::file_size(path, ec);
+    if (ec)
+        return false;
+
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+        return false;
+
+    BinaryHeader header{};
+    if (!in.read(reinterpret_cast<char *>(&header), sizeof(header)))
+        return false;
+    if (std::memcmp(header.magic, BINARY_MAGIC, 4) != 0 || header.version != BINARY_VERSION || header.sourceHash != hash)
+        return false;
+
+    // Torn or corrupt files fall back to compiling instead of sizing allocations
+    if (sizeof(header) + (uint64_t)header.driverLength + header.binaryLength != fileSize)
+        return false;
+
+    const std::string &current = DriverString();
+    std::string stored(header.driverLength, '\0');
+    if (!in.read(stored.data(), header.driverLength) || stored != current)
+        return false;
+
+    std::vector<char> binary(header.binaryLength);
+    if (!in.read(binary.data(), header.binaryLength))
+        return false;
+
+    GLExt::ProgramBinary(program, header.format, binary.data(), (GLsizei)binary.size());
+
+    // Drivers reject binaries after updates even when the strings match
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (linked != GL_TRUE)
+        return false;
+
+    stats.binaryHits++;
+    return true;
+}
+
+void ShaderCache::PrepareBinary(unsigned int program)
+{
+    if (UseBinaries())
+        GLExt::ProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+}
+
+void ShaderCache::OnCompiled(uint64_t hash, unsigned int program)
+{
+    stats.compiles++;
+    if (!UseBinaries())
+        return;
+
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return;
+
+    std::vector<char> binary((size_t)length);
+    GLenum format = 0;
+    GLsizei written = 0;
+    GLExt::GetProgramBinary(program, length, &written, &format, binary.data());
+    if (written <= 0)
+        return;
+
+    std::string path = BinaryPath(hash);
+    std::error_code ec;
+    fs::create_directories(fs::path(path).parent_path(), ec);
+
+    const std::string &current = DriverString();
+
+    // Through a temp file, so a crash or a second instance never leaves a torn binary
+    std::string temp = FileSystem::TempPath(path);
+    {
+        std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+        if (!out)
+        {
+            std::cout << "[ShaderCache] Cannot write program binary: " << path << std::endl;
+            return;
+        }
+
+        BinaryHeader header{};
+        std::memcpy(header.magic, BINARY_MAGIC, 4);
+        header.version = BINARY_VERSION;
+        header.sourceHash = hash;
+        header.format = format;
+        header.driverLength = (uint32_t)current.size();
+        header.binaryLength = (uint32_t)written;
+
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        out.write(current.data(), (std::streamsize)current.size());
+        out.write(binary.data(), written);
+        if (!out)
+        {
+            out.close();
+            fs::remove(temp, ec);
+            return;
+        }
+    }
+
+    fs::rename(temp, path, ec);
+    if (ec)
+        fs::remove(temp, ec);
+}
+
+bool ShaderCache::UseBinaries()
+{
+    if (binarySupport < 0)
+        binarySupport = GLExt::SupportsProgramBinary() ? 1 : 0;
+    return binaryCache && binarySupport == 1;
+}
+
+const std::string &ShaderCache::DriverString()
+{
+    if (driver.empty())
+    {
+        auto str = [](GLenum name)
+        {
+            const GLubyte *value = glGetString(name);
+            return value ? std::string(reinterpret_cast<const char *>(value)) : std::string();
+        };
+        driver = str(GL_VENDOR) + "|" + str(GL_RENDERER) + "|" + str(GL_VERSION);
+    }
+    return driver;
+}
+
+std::string ShaderCache::BinaryPath(uint64_t hash) const
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)hash);
+    return (fs::path(ASSET_CACHE_DIR) / "shaders" / name).string();
+}
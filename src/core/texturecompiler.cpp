@@ -0,0 +1,606 @@
+#include <engine/render/texturecompiler.hpp>
+#include <engine/configure.hpp>
+#include <engine/threadpool.hpp>
+#include <engine/hash.hpp>
+#include <engine/filesystem.hpp>
+#include <engine/assetdatabase.hpp>
+#include <engine/tracer.hpp>
+#include <stb/stb_image.h>
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    constexpr char OTEX_MAGIC[4] = {'O', 'T', 'E', 'X'};
+    constexpr uint32_t OTEX_VERSION = 2;
+
+    // .otex file layout: header, then per level {width, height, byte size, blocks}.
+    struct OTexHeader
+    {
+        char magic[4];
+        uint32_t version;
+        uint32_t codec;
+        uint32_t width;
+        uint32_t height;
+        uint32_t channels;
+        uint32_t srgb;
+        uint32_t levels;
+        uint64_t sourceHash; // content, so touching a file does not re-encode it
+        uint64_t reserved;
+    };
+
+    struct OTexLevel
+    {
+        uint32_t width;
+        uint32_t height;
+        uint32_t size;
+    };
+
+    size_t BlockBytes(TextureCodec codec)
+    {
+        return codec == TextureCodec::BC3 ? 16 : 8;
+    }
+
+    // Bytes of one width x height level; uncompressed levels are 1 or 4 channels.
+    uint64_t LevelBytes(TextureCodec codec, int channels, uint64_t width, uint64_t height)
+    {
+        if (codec == TextureCodec::None)
+            return width * height * (channels == 1 ? 1u : 4u);
+        return ((width + 3) / 4) * ((height + 3) / 4) * BlockBytes(codec);
+    }
+
+    // ------------------------
+    // Color space
+    // ------------------------
+    struct SrgbTable
+    {
+        float toLinear[256];
+
+        SrgbTable()
+        {
+            for (int i = 0; i < 256; ++i)
+            {
+                float c = i / 255.0f;
+                toLinear[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+            }
+        }
+    };
+
+    const SrgbTable &Srgb()
+    {
+        static SrgbTable table;
+        return table;
+    }
+
+    uint8_t LinearToSrgb(float c)
+    {
+        c = glm::clamp(c, 0.0f, 1.0f);
+        c = c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+        return (uint8_t)std::lround(c * 255.0f);
+    }
+
+    // 2x2 box filter; odd edges reuse the last row/column.
+    // Color channels of sRGB images are averaged in linear space.
+    TextureLevel Downsample(const TextureLevel &src, int channels, bool srgb)
+    {
+        TextureLevel dst;
+        dst.width = std::max(1, src.width / 2);
+        dst.height = std::max(1, src.height / 2);
+        dst.data.resize((size_t)dst.width * dst.height * channels);
+
+        const SrgbTable &table = Srgb();
+        for (int y = 0; y < dst.height; ++y)
+        {
+            int y0 = std::min(y * 2, src.height - 1);
+            int y1 = std::min(y * 2 + 1, src.height - 1);
+            for (int x = 0; x < dst.width; ++x)
+            {
+                int x0 = std::min(x * 2, src.width - 1);
+                int x1 = std::min(x * 2 + 1, src.width - 1);
+                const uint8_t *p[4] = {
+                    &src.data[((size_t)y0 * src.width + x0) * channels],
+                    &src.data[((size_t)y0 * src.width + x1) * channels],
+                    &src.data[((size_t)y1 * src.width + x0) * channels],
+                    &src.data[((size_t)y1 * src.width + x1) * channels]};
+
+                uint8_t *out = &dst.data[((size_t)y * dst.width + x) * channels];
+                for (int c = 0; c < channels; ++c)
+                {
+                    bool linearize = srgb && channels == 4 && c < 3;
+                    if (linearize)
+                    {
+                        float sum = table.toLinear[p[0][c]] + table.toLinear[p[1][c]] +
+                                    table.toLinear[p[2][c]] + table.toLinear[p[3][c]];
+                        out[c] = LinearToSrgb(sum * 0.25f);
+                    }
+                    else
+                    {
+                        out[c] = (uint8_t)((p[0][c] + p[1][c] + p[2][c] + p[3][c] + 2) / 4);
+                    }
+                }
+            }
+        }
+        return dst;
+    }
+
+    // ------------------------
+    // Block encoding
+    // ------------------------
+    uint16_t To565(const glm::vec3 &c)
+    {
+        int r = glm::clamp((int)std::lround(c.r * 31.0f / 255.0f), 0, 31);
+        int g = glm::clamp((int)std::lround(c.g * 63.0f / 255.0f), 0, 63);
+        int b = glm::clamp((int)std::lround(c.b * 31.0f / 255.0f), 0, 31);
+        return (uint16_t)((r << 11) | (g << 5) | b);
+    }
+
+    glm::vec3 From565(uint16_t c)
+    {
+        int r = (c >> 11) & 31;
+        int g = (c >> 5) & 63;
+        int b = c & 31;
+        return glm::vec3((r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2));
+    }
+
+    // Picks indices for fixed endpoints; returns the squared error.
+    float FitIndices(const glm::vec3 px[16], uint16_t c0, uint16_t c1, uint32_t &indices)
+    {
+        glm::vec3 palette[4];
+        palette[0] = From565(c0);
+        palette[1] = From565(c1);
+        palette[2] = (palette[0] * 2.0f + palette[1]) / 3.0f;
+        palette[3] = (palette[0] + palette[1] * 2.0f) / 3.0f;
+
+        indices = 0;
+        float error = 0.0f;
+        for (int i = 0; i < 16; ++i)
+        {
+            int best = 0;
+            float bestDist = 1e30f;
+            for (int j = 0; j < 4; ++j)
+            {
+                glm::vec3 d = px[i] - palette[j];
+                float dist = glm::dot(d, d);
+                if (dist < bestDist)
+                {
+                    bestDist = dist;
+                    best = j;
+                }
+            }
+            indices |= (uint32_t)best << (i * 2);
+            error += bestDist;
+        }
+        return error;
+    }
+
+    void WriteColorBlock(uint16_t c0, uint16_t c1, uint32_t indices, uint8_t out[8])
+    {
+        if (c0 == c1)
+            indices = 0;
+        out[0] = (uint8_t)(c0 & 0xFF);
+        out[1] = (uint8_t)(c0 >> 8);
+        out[2] = (uint8_t)(c1 & 0xFF);
+        out[3] = (uint8_t)(c1 >> 8);
+        std::memcpy(out + 4, &indices, 4);
+    }
+
+    // Endpoints from the principal axis of the block, then one least squares refit.
+    void EncodeColorBlock(const uint8_t rgba[64], uint8_t out[8])
+    {
+        glm::vec3 px[16];
+        glm::vec3 mean(0.0f);
+        for (int i = 0; i < 16; ++i)
+        {
+            px[i] = glm::vec3(rgba[i * 4 + 0], rgba[i * 4 + 1], rgba[i * 4 + 2]);
+            mean += px[i];
+        }
+        mean /= 16.0f;
+
+        float cov[6] = {};
+        for (int i = 0; i < 16; ++i)
+        {
+            glm::vec3 d = px[i] - mean;
+            cov[0] += d.r * d.r;
+            cov[1] += d.r * d.g;
+            cov[2] += d.r * d.b;
+            cov[3] += d.g * d.g;
+            cov[4] += d.g * d.b;
+            cov[5] += d.b * d.b;
+        }
+
+        glm::vec3 axis(1.0f, 1.0f, 1.0f);
+        for (int iter = 0; iter < 8; ++iter)
+        {
+            glm::vec3 next(
+                cov[0] * axis.r + cov[1] * axis.g + cov[2] * axis.b,
+                cov[1] * axis.r + cov[3] * axis.g + cov[4] * axis.b,
+                cov[2] * axis.r + cov[4] * axis.g + cov[5] * axis.b);
+            float len = glm::length(next);
+            if (len < 1e-6f)
+                break;
+            axis = next / len;
+        }
+
+        float minT = 1e30f, maxT = -1e30f;
+        for (int i = 0; i < 16; ++i)
+        {
+            float t = glm::dot(px[i] - mean, axis);
+            minT = std::min(minT, t);
+            maxT = std::max(maxT, t);
+        }
+
+        uint16_t c0 = To565(mean + axis * maxT);
+        uint16_t c1 = To565(mean + axis * minT);
+        // 4-color mode needs c0 > c1.
+        if (c0 < c1)
+            std::swap(c0, c1);
+        uint32_t indices;
+        float error = FitIndices(px, c0, c1, indices);
+
+        // Solve for the endpoints that best reproduce the chosen indices.
+        static const float weights[4] = {1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f};
+        float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+        glm::vec3 ax(0.0f), bx(0.0f);
+        for (int i = 0; i < 16; ++i)
+        {
+            float a = weights[(indices >> (i * 2)) & 3];
+            float b = 1.0f - a;
+            aa += a * a;
+            ab += a * b;
+            bb += b * b;
+            ax += px[i] * a;
+            bx += px[i] * b;
+        }
+
+        float det = aa * bb - ab * ab;
+        if (std::fabs(det) > 1e-6f)
+        {
+            glm::vec3 e0 = (ax * bb - bx * ab) / det;
+            glm::vec3 e1 = (bx * aa - ax * ab) / det;
+
+            uint16_t r0 = To565(glm::clamp(e0, 0.0f, 255.0f));
+            uint16_t r1 = To565(glm::clamp(e1, 0.0f, 255.0f));
+            if (r0 < r1)
+                std::swap(r0, r1);
+            uint32_t refined;
+            float refinedError = FitIndices(px, r0, r1, refined);
+            if (refinedError < error)
+            {
+                c0 = r0;
+                c1 = r1;
+                indices = refined;
+            }
+        }
+
+        WriteColorBlock(c0, c1, indices, out);
+    }
+
+    void EncodeValueBlock(const uint8_t values[16], uint8_t out[8])
+    {
+        uint8_t a0 = 0, a1 = 255;
+        for (int i = 0; i < 16; ++i)
+        {
+            a0 = std::max(a0, values[i]);
+            a1 = std::min(a1, values[i]);
+        }
+
+        std::memset(out, 0, 8);
+        out[0] = a0;
+        out[1] = a1;
+        if (a0 == a1)
+            return;
+
+        // 8-value mode (a0 > a1): index 0 = a0, 1 = a1, 2..7 interpolate from a0 to a1.
+        int palette[8] = {a0, a1};
+        for (int i = 1; i <= 6; ++i)
+            palette[i + 1] = ((7 - i) * a0 + i * a1 + 3) / 7;
+
+        uint64_t bits = 0;
+        for (int i = 0; i < 16; ++i)
+        {
+            int best = 0, bestDist = 1 << 30;
+            for (int j = 0; j < 8; ++j)
+            {
+                int d = std::abs(palette[j] - values[i]);
+                if (d < bestDist)
+                {
+                    bestDist = d;
+                    best = j;
+                }
+            }
+            bits |= (uint64_t)best << (i * 3);
+        }
+        for (int i = 0; i < 6; ++i)
+            out[2 + i] = (uint8_t)(bits >> (i * 8));
+    }
+
+    TextureLevel EncodeLevel(const TextureLevel &src, int channels, TextureCodec codec)
+    {
+        int blocksX = (src.width + 3) / 4;
+        int blocksY = (src.height + 3) / 4;
+        size_t blockBytes = BlockBytes(codec);
+
+        TextureLevel dst;
+        dst.width = src.width;
+        dst.height = src.height;
+        dst.data.resize((size_t)blocksX * blocksY * blockBytes);
+
+        auto encodeRow = [&](size_t by)
+        {
+            uint8_t block[64];
+            for (int bx = 0; bx < blocksX; ++bx)
+            {
+                // Partial blocks at the edges repeat the last texel.
+                for (int i = 0; i < 16; ++i)
+                {
+                    int x = std::min(bx * 4 + (i & 3), src.width - 1);
+                    int y = std::min((int)by * 4 + (i >> 2), src.height - 1);
+                    const uint8_t *p = &src.data[((size_t)y * src.width + x) * channels];
+                    if (channels == 1)
+                        block[i] = p[0];
+                    else
+                        std::memcpy(block + i * 4, p, 4);
+                }
+
+                uint8_t *out = &dst.data[((size_t)by * blocksX + bx) * blockBytes];
+                switch (codec)
+                {
+                case TextureCodec::BC1:
+                    TextureCompiler::EncodeBC1(block, out);
+                    break;
+                case TextureCodec::BC3:
+                    TextureCompiler::EncodeBC3(block, out);
+                    break;
+                case TextureCodec::BC4:
+                    TextureCompiler::EncodeBC4(block, out);
+                    break;
+                default:
+                    break;
+                }
+            }
+        };
+
+        // Small mips aren't worth the dispatch.
+        if (blocksX * blocksY >= 256)
+            ThreadPool::Get().ParallelFor((size_t)blocksY, encodeRow);
+        else
+            for (int by = 0; by < blocksY; ++by)
+                encodeRow((size_t)by);
+
+        return dst;
+    }
+
+    // ------------------------
+    // Cache files
+    // ------------------------
+    fs::path CachePath(const std::string &path, bool srgb)
+    {
+        std::error_code ec;
+        fs::path canonical = fs::weakly_canonical(path, ec);
+        std::string key = (ec ? fs::path(path).lexically_normal() : canonical).generic_string();
+
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx%s.otex", (unsigned long long)Hash::Fnv1a(key), srgb ? "s" : "");
+        return fs::path(ASSET_CACHE_DIR) / "textures" / name;
+    }
+
+    bool ReadCache(const fs::path &file, uint64_t sourceHash, TextureData &out)
+    {
+        std::error_code ec;
+        uint64_t remaining = (uint64_t)fs::file_size(file, ec);
+        if (ec || remaining < sizeof(OTexHeader))
+            return false;
+        remaining -= sizeof(OTexHeader);
+
+        std::ifstream in(file, std::ios::binary);
+        if (!in)
+            return false;
+
+        OTexHeader header{};
+        if (!in.read(reinterpret_cast<char *>(&header), sizeof(header)))
+            return false;
+        if (std::memcmp(header.magic, OTEX_MAGIC, 4) != 0 || header.version != OTEX_VERSION)
+            return false;
+        if (header.sourceHash != sourceHash)
+            return false;
+
+        // Nothing from the file reaches GL unchecked
+        if (header.codec > (uint32_t)TextureCodec::BC4 || header.channels == 0 || header.channels > 4)
+            return false;
+        if (header.width == 0 || header.height == 0 || header.width > 16384 || header.height > 16384)
+            return false;
+        if (header.levels == 0 || header.levels > 15 || header.levels * sizeof(OTexLevel) > remaining)
+            return false;
+
+        out.width = (int)header.width;
+        out.height = (int)header.height;
+        out.channels = (int)header.channels;
+        out.srgb = header.srgb != 0;
+        out.codec = (TextureCodec)header.codec;
+        out.levels.resize(header.levels);
+
+        for (auto &level : out.levels)
+        {
+            OTexLevel info{};
+            if (!in.read(reinterpret_cast<char *>(&info), sizeof(info)))
+                return false;
+            remaining -= sizeof(info);
+
+            if (info.width == 0 || info.height == 0 || info.width > header.width || info.height > header.height)
+                return false;
+            if (info.size != LevelBytes(out.codec, out.channels, info.width, info.height) || info.size > remaining)
+                return false;
+            remaining -= info.size;
+
+            level.width = (int)info.width;
+            level.height = (int)info.height;
+            level.data.resize(info.size);
+            if (!in.read(reinterpret_cast<char *>(level.data.data()), info.size))
+                return false;
+        }
+        return true;
+    }
+
+    void WriteCache(const fs::path &file, uint64_t sourceHash, const TextureData &data)
+    {
+        std::error_code ec;
+        fs::create_directories(file.parent_path(), ec);
+
+        // Write to a temp file first so a crash never leaves a truncated cache entry.
+        // The same image can be encoded by two jobs at once (e.g. as diffuse and specular).
+        fs::path temp = FileSystem::TempPath(file.string());
+        {
+            std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+            if (!out)
+            {
+                std::cout << "[TextureCompiler] Cannot write cache file: " << file.string() << std::endl;
+                return;
+            }
+
+            OTexHeader header{};
+            std::memcpy(header.magic, OTEX_MAGIC, 4);
+            header.version = OTEX_VERSION;
+            header.codec = (uint32_t)data.codec;
+            header.width = (uint32_t)data.width;
+            header.height = (uint32_t)data.height;
+            header.channels = (uint32_t)data.channels;
+            header.srgb = data.srgb ? 1 : 0;
+            header.levels = (uint32_t)data.levels.size();
+            header.sourceHash = sourceHash;
+            out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+            for (auto &level : data.levels)
+            {
+                OTexLevel info{(uint32_t)level.width, (uint32_t)level.height, (uint32_t)level.data.size()};
+                out.write(reinterpret_cast<const char *>(&info), sizeof(info));
+                out.write(reinterpret_cast<const char *>(level.data.data()), level.data.size());
+            }
+        }
+
+        fs::rename(temp, file, ec);
+        if (ec)
+            fs::remove(temp, ec);
+    }
+}
+
+namespace TextureCompiler
+{
+    void EncodeBC1(const uint8_t rgba[64], uint8_t out[8])
+    {
+        EncodeColorBlock(rgba, out);
+    }
+
+    void EncodeBC3(const uint8_t rgba[64], uint8_t out[16])
+    {
+        uint8_t alpha[16];
+        for (int i = 0; i < 16; ++i)
+            alpha[i] = rgba[i * 4 + 3];
+        EncodeValueBlock(alpha, out);
+        EncodeColorBlock(rgba, out + 8);
+    }
+
+    void EncodeBC4(const uint8_t values[16], uint8_t out[8])
+    {
+        EncodeValueBlock(values, out);
+    }
+
+    TextureData Decode(const std::string &path, bool srgb)
+    {
+        TRACE_SCOPE("Texture decode", path);
+        FileView file = FileSystem::Get().Open(path);
+        if (!file.IsOpen())
+            throw std::runtime_error("Failed to load texture: " + path);
+
+        int width = 0, height = 0, channels = 0;
+        if (!stbi_info_from_memory(file.Data(), (int)file.Size(), &width, &height, &channels))
+            throw std::runtime_error("Failed to load texture: " + path);
+
+        // Everything but single channel images is expanded to RGBA.
+        int wanted = channels == 1 ? 1 : 4;
+
+        stbi_set_flip_vertically_on_load_thread(true);
+        unsigned char *pixels = stbi_load_from_memory(file.Data(), (int)file.Size(), &width, &height, &channels, wanted);
+        if (!pixels)
+            throw std::runtime_error("Failed to load texture: " + path);
+
+        TextureData data;
+        data.width = width;
+        data.height = height;
+        data.channels = channels;
+        data.srgb = srgb && wanted == 4;
+        data.codec = TextureCodec::None;
+
+        TextureLevel level;
+        level.width = width;
+        level.height = height;
+        level.data.assign(pixels, pixels + (size_t)width * height * wanted);
+        data.levels.push_back(std::move(level));
+
+        stbi_image_free(pixels);
+        return data;
+    }
+
+    TextureData Compress(const TextureData &source)
+    {
+        if (source.codec != TextureCodec::None || source.levels.empty())
+            return source;
+
+        int channels = source.channels == 1 ? 1 : 4;
+        TextureCodec codec = TextureCodec::BC4;
+        if (channels == 4)
+        {
+            codec = TextureCodec::BC1;
+            const auto &pixels = source.levels[0].data;
+            for (size_t i = 3; i < pixels.size(); i += 4)
+                if (pixels[i] != 255)
+                {
+                    codec = TextureCodec::BC3;
+                    break;
+                }
+        }
+
+        TextureData out;
+        out.width = source.width;
+        out.height = source.height;
+        out.channels = source.channels;
+        out.srgb = source.srgb;
+        out.codec = codec;
+
+        TextureLevel current = source.levels[0];
+        for (;;)
+        {
+            out.levels.push_back(EncodeLevel(current, channels, codec));
+            if (current.width == 1 && current.height == 1)
+                break;
+            current = Downsample(current, channels, source.srgb);
+        }
+        return out;
+    }
+
+    TextureData LoadCompressed(const std::string &path, bool srgb)
+    {
+        TRACE_SCOPE("Texture load (BCn)", path);
+        uint64_t sourceHash = 0;
+        if (!AssetDatabase::Get().ContentHash(path, sourceHash))
+            throw std::runtime_error("Failed to load texture: " + path);
+
+        fs::path cacheFile = CachePath(path, srgb);
+
+        TextureData data;
+        if (ReadCache(cacheFile, sourceHash, data))
+            return data;
+
+        data = Compress(Decode(path, srgb));
+        WriteCache(cacheFile, sourceHash, data);
+        return data;
+    }
+}
@@ -0,0 +1,172 @@
+#include <engine/tracer.hpp>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+
+namespace
+{
+    void WriteJsonString(std::ostream &out, const std::string &text)
+    {
+        out << '"';
+        for (char c : text)
+        {
+            switch (c)
+            {
+            case '"':
+                out << "\\\"";
+                break;
+            case '\\':
+                out << "\\\\";
+                break;
+            case '\n':
+                out << "\\n";
+                break;
+            case '\t':
+                out << "\\t";
+                break;
+            default:
+                if ((unsigned char)c < 0x20)
+                    out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (int)c << std::dec << std::setfill(' ');
+                else
+                    out << c;
+            }
+        }
+        out << '"';
+    }
+}
+
+void Tracer::Start()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    events.clear();
+    threads.clear();
+    threads.emplace(std::this_thread::get_id(), 0u); // the starting thread is 0
+    epoch = Clock::now();
+    active.store(true, std::memory_order_relaxed);
+}
+
+void Tracer::Record(const char *name, std::string detail, Clock::time_point start, Clock::time_point end)
+{
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!IsActive())
+        return;
+
+    // Small stable thread ids read better in the trace viewer than hashes
+    auto it = threads.emplace(std::this_thread::get_id(), (uint32_t)threads.size()).first;
+
+    events.push_back({name,
+                      std::move(detail),
+                      duration_cast<microseconds>(start - epoch).count(),
+                      duration_cast<microseconds>(end - start).count(),
+                      it->second});
+}
+
+void Tracer::Stop(const std::string &tracePath)
+{
+    double wallMs = 0.0;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!IsActive())
+            return;
+        active.store(false, std::memory_order_relaxed);
+        wallMs = std::chrono::duration<double, std::milli>(Clock::now() - epoch).count();
+    }
+
+    PrintSummary(wallMs);
+
+    if (WriteChromeTrace(tracePath))
+        std::cout << "Trace    : " << tracePath << "\n\n";
+    else
+        std::cout << "[Tracer] Cannot write trace: " << tracePath << "\n\n";
+}
+
+void Tracer::PrintSummary(double wallMs) const
+{
+    struct Total
+    {
+        const char *name;
+        size_t count = 0;
+        int64_t total = 0;
+        int64_t longest = 0;
+    };
+
+    std::vector<Total> totals;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::map<std::string, size_t> index;
+        for (auto &e : events)
+        {
+            auto it = index.emplace(e.name, totals.size()).first;
+            if (it->second == totals.size())
+                totals.push_back({e.name});
+
+            Total &t = totals[it->second];
+            t.count++;
+            t.total += e.duration;
+            t.longest = std::max(t.longest, e.duration);
+        }
+    }
+
+    std::sort(totals.begin(), totals.end(), [](const Total &a, const Total &b)
+              { return a.total > b.total; });
+
+    std::ios state(nullptr);
+    state.copyfmt(std::cout);
+
+    // Scopes nest and run on several threads, so totals may exceed the wall time
+    std::cout << "=============================================\n";
+    std::cout << "          STARTUP TRACE                      \n";
+    std::cout << "=============================================\n";
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "Wall     : " << wallMs << " ms\n";
+    std::cout << std::left << std::setw(28) << "Scope" << std::right
+              << std::setw(7) << "Count" << std::setw(12) << "Total ms" << std::setw(12) << "Max ms" << "\n";
+    for (auto &t : totals)
+        std::cout << std::left << std::setw(28) << t.name << std::right
+                  << std::setw(7) << t.count
+                  << std::setw(12) << t.total / 1000.0
+                  << std::setw(12) << t.longest / 1000.0 << "\n";
+
+    std::cout.copyfmt(state);
+}
+
+bool Tracer::WriteChromeTrace(const std::string &path) const
+{
+    std::error_code ec;
+    auto parent = std::filesystem::path(path).parent_path();
+    if (!parent.empty())
+        std::filesystem::create_directories(parent, ec);
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out)
+        return false;
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // Complete ("X") events; timestamps are already in microseconds
+    out << "{\"traceEvents\":[\n";
+    for (size_t i = 0; i < events.size(); ++i)
+    {
+        const Event &e = events[i];
+        out << "{\"name\":";
+        WriteJsonString(out, e.name);
+        out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << e.thread
+            << ",\"ts\":" << e.start << ",\"dur\":" << e.duration;
+        if (!e.detail.empty())
+        {
+            out << ",\"args\":{\"detail\":";
+            WriteJsonString(out, e.detail);
+            out << "}";
+        }
+        out << (i + 1 < events.size() ? "},\n" : "}\n");
+    }
+    out << "],\"displayTimeUnit\":\"ms\"}\n";
+
+    return (bool)out;
+}
@@ -1,9 +1,12 @@
 #include <engine/engine.hpp>
 #include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <vector>
 
 namespace Engine
 {
-    void Engine::Initialize(int width, int height, const char *title)
+    void Engine::Initialize(int width, int height, const char *title, bool headless, const char *scenePath)
     {
         screenWidth = width;
         screenHeight = height;
@@ -13,16 +16,47 @@ namespace Engine
         std::cout << "          ENGINE INITIALIZATION             \n";
         std::cout << "=============================================\n\n";
 
+        // Recorded until the background loads started here have finished
+        Tracer::Get().Start();
+        TRACE_SCOPE("Engine::Initialize");
+
         // Initialize platform/window
-        Platform::Get().Initialize(screenWidth, screenHeight, appTitle);
+        {
+            TRACE_SCOPE("Platform::Initialize");
+            Platform::Get().Initialize(screenWidth, screenHeight, appTitle, headless);
+            if (headless)
+                Platform::Get().SetFixedDeltaTime(1.0f / 60.0f);
+        }
+
+        // Packed assets take priority over loose files when present
+        {
+            TRACE_SCOPE("FileSystem::Mount", ASSET_PACK_FILE);
+            FileSystem::Get().Mount(ASSET_PACK_FILE);
+        }
 
         // Initialize physics
-        PhysicsSystem::Get().Initialize();
+        {
+            TRACE_SCOPE("PhysicsSystem::Initialize");
+            PhysicsSystem::Get().Initialize();
+        }
 
         // Create main scene
-        scene = std::make_shared<Scene>(screenWidth, screenHeight, "MainScene");
+        {
+            TRACE_SCOPE("Scene create");
+            scene = std::make_shared<Scene>(screenWidth, screenHeight, "MainScene");
+        }
 
-        SetupDefaultScene();
+        if (scenePath)
+        {
+            auto stats = SceneSerializer::Load(scenePath, scene);
+            std::cout << "[Scene] Loaded " << scenePath << ": " << stats.entities << " entities, "
+                      << stats.components << " components in " << stats.milliseconds << " ms\n";
+        }
+        else
+        {
+            TRACE_SCOPE("SetupDefaultScene");
+            SetupDefaultScene();
+        }
 
         // Window resize callback
         Platform::Get().ListenCallback([this](int w, int h)
@@ -53,19 +87,29 @@ namespace Engine
         pl->range = 40.0f;
         point->transform.position = {-3.0f, 3.0f, 2.0f};
 
-        // Example models
-        auto model = Model::Load("assets/models/octahedron-sharpe.fbx", scene);
-        model->AddComponent<SphereCollider3D>();
-        model->AddComponent<RigidBody3D>();
-        model->transform.position = {0.0f, 1.0f, 0.0f};
-
-        auto model1 = Model::Load("assets/models/cube.fbx", scene);
-        model1->AddComponent<BoxCollider3D>();
-        model1->transform.position.y = -3.0f;
-        // model1->AddComponent<RigidBody3D>();
-
-        auto model2 = Model::Load("assets/resources/arce.fbx", scene);
-        model2->transform.scale = glm::vec3(0.01f);
+        // Example models, loaded in the background while the loop runs
+        SceneLoader::Get().Load(
+            scene,
+            {{"assets/models/octahedron-sharpe.fbx", MeshResidency::GpuOnly,
+              [](const std::shared_ptr<Entity> &model)
+              {
+                  model->AddComponent<SphereCollider3D>();
+                  model->AddComponent<RigidBody3D>();
+                  model->transform.position = {0.0f, 1.0f, 0.0f};
+              }},
+             {"assets/models/cube.fbx", MeshResidency::KeepCpu,
+              [](const std::shared_ptr<Entity> &model1)
+              {
+                  model1->AddComponent<BoxCollider3D>();
+                  model1->AddComponent<Occluder>();
+                  model1->transform.position.y = -3.0f;
+                  // model1->AddComponent<RigidBody3D>();
+              }},
+             {"assets/resources/arce.fbx", MeshResidency::GpuOnly,
+              [](const std::shared_ptr<Entity> &model2)
+              {
+                  model2->transform.scale = glm::vec3(0.01f);
+              }}});
 
         auto canvas = scene->CreateObject("Canvas");
         canvas->AddComponent<Canvas>(screenWidth, screenHeight);
@@ -85,6 +129,16 @@ namespace Engine
         // canvas->AddChild(text);
     }
 
+    void Engine::FinishStartup()
+    {
+        if (!startupPending || !SceneLoader::Get().IsIdle() || !TextureStreamer::Get().IsIdle())
+            return;
+
+        startupPending = false;
+        Tracer::Get().Stop(STARTUP_TRACE_FILE);
+        AssetDatabase::Get().Save();
+    }
+
     void Engine::Run()
     {
         if (!scene)
@@ -93,19 +147,172 @@ namespace Engine
         scene->Begin();
 
         while (!Platform::Get().ShouldClose())
+            Frame();
+    }
+
+    void Engine::Frame()
+    {
+        Platform::Get().PollEvent();
+        InputManager::Get().Update();
+        TextureStreamer::Get().Pump();
+        SceneLoader::Get().Pump();
+        FinishStartup();
+
+        float dt = Platform::Get().GetDeltaTime();
+        scene->Update(dt);
+
+        Platform::Get().SwapBuffer();
+    }
+
+    void Engine::RunHeadless(uint32_t frameCount, float timeBudget)
+    {
+        if (!scene)
+            return;
+
+        using Clock = std::chrono::steady_clock;
+
+        scene->Begin();
+
+        // Warm-up: frames spent importing and uploading would dominate the timings
+        uint32_t warmupFrames = 0;
+        auto warmupStart = Clock::now();
+        while (!Platform::Get().ShouldClose() && !(SceneLoader::Get().IsIdle() && TextureStreamer::Get().IsIdle()))
+        {
+            Frame();
+            warmupFrames++;
+        }
+        double warmupMs = std::chrono::duration<double, std::milli>(Clock::now() - warmupStart).count();
+
+        std::vector<double> frameTimes;
+        frameTimes.reserve(frameCount ? frameCount : 1024);
+
+        auto start = Clock::now();
+        while (!Platform::Get().ShouldClose())
+        {
+            if (frameCount && frameTimes.size() >= frameCount)
+                break;
+            if (timeBudget > 0.0f && std::chrono::duration<float>(Clock::now() - start).count() >= timeBudget)
+                break;
+
+            auto frameStart = Clock::now();
+            Frame();
+            frameTimes.push_back(std::chrono::duration<double, std::milli>(Clock::now() - frameStart).count());
+        }
+
+        if (frameTimes.empty())
+            return;
+
+        double total = 0.0;
+        for (double t : frameTimes)
+            total += t;
+
+        std::vector<double> sorted = frameTimes;
+        std::sort(sorted.begin(), sorted.end());
+
+        std::cout << "=============================================\n";
+        std::cout << "          HEADLESS BENCHMARK                 \n";
+        std::cout << "=============================================\n";
+        std::cout << "Renderer : " << glGetString(GL_RENDERER) << "\n";
+        std::cout << "Size     : " << screenWidth << "x" << screenHeight << "\n";
+        std::cout << "Warm-up  : " << warmupFrames << " frames, " << warmupMs << " ms (loading, not measured)\n";
+        std::cout << "Frames   : " << frameTimes.size() << "\n";
+        std::cout << "Total    : " << total << " ms\n";
+        std::cout << "Average  : " << total / frameTimes.size() << " ms\n";
+        std::cout << "Median   : " << sorted[sorted.size() / 2] << " ms\n";
+        std::cout << "P99      : " << sorted[std::min(sorted.size() - 1, sorted.size() * 99 / 100)] << " ms\n";
+        std::cout << "Min/Max  : " << sorted.front() << " / " << sorted.back() << " ms\n\n";
+    }
+
+    bool Engine::SaveScene(const std::string &path)
+    {
+        if (!scene)
+            return false;
+
+        SceneSerializer::Stats stats;
+        if (!SceneSerializer::Save(*scene, path, &stats))
         {
-            Platform::Get().PollEvent();
-            InputManager::Get().Update();
+            std::cout << "[Scene] Cannot write " << path << std::endl;
+            return false;
+        }
+
+        std::cout << "[Scene] Saved " << path << ": " << stats.entities << " entities, "
+                  << stats.components << " components";
+        if (stats.skipped)
+            std::cout << " (" << stats.skipped << " not serializable)";
+        std::cout << std::endl;
+        return true;
+    }
+
+    void Engine::BenchmarkSceneIO(uint32_t entityCount)
+    {
+        const std::string path = std::string(ASSET_CACHE_DIR) + "/scene_bench.oscn";
+        const uint32_t groupSize = 100;
+
+        // Groups of children under plain roots, a shared mesh and a mix of components
+        auto source = std::make_shared<Scene>(screenWidth, screenHeight, "BenchSource");
+        auto cube = ModelRegistry::Get().Load("assets/models/cube.fbx");
+        std::vector<std::shared_ptr<Entity>> roots;
+        std::shared_ptr<Entity> group;
+        for (uint32_t i = 0; i < entityCount; ++i)
+        {
+            if (i % groupSize == 0)
+            {
+                group = std::make_shared<Entity>("Group");
+                group->transform.position = {(float)(i / groupSize), 0.0f, 0.0f};
+                roots.push_back(group);
+                continue;
+            }
+
+            auto entity = std::make_shared<Entity>("Item");
+            entity->transform.position = {0.0f, (float)(i % groupSize), 0.0f};
+            group->AddChild(entity);
 
-            float dt = Platform::Get().GetDeltaTime();
-            scene->Update(dt);
+            for (auto &mesh : cube->GetMeshes())
+            {
+                entity->AddComponent<MeshFilter>(mesh);
+                entity->AddComponent<MeshRenderer>();
+            }
+            entity->AddComponent<BoxCollider3D>();
+            if (i % 10 == 0)
+                entity->AddComponent<RigidBody3D>();
+            if (i % 50 == 0)
+            {
+                auto light = entity->AddComponent<Light>();
+                light->type = LightType::Point;
+            }
+        }
+        source->AddEntities(roots);
 
-            Platform::Get().SwapBuffer();
+        SceneSerializer::Stats saved;
+        if (!SceneSerializer::Save(*source, path, &saved))
+        {
+            std::cout << "[Scene] Cannot write " << path << std::endl;
+            return;
         }
+
+        auto target = std::make_shared<Scene>(screenWidth, screenHeight, "BenchTarget");
+        SceneSerializer::Stats loaded = SceneSerializer::Load(path, target);
+
+        std::cout << "=============================================\n";
+        std::cout << "          SCENE IO BENCHMARK                 \n";
+        std::cout << "=============================================\n";
+        std::cout << "Entities   : " << loaded.entities << "\n";
+        std::cout << "Components : " << loaded.components << "\n";
+        std::cout << "File size  : " << loaded.bytes / 1024 << " KB\n";
+        std::cout << "Save       : " << saved.milliseconds << " ms\n";
+        std::cout << "Load       : " << loaded.milliseconds << " ms\n\n";
     }
 
     void Engine::Shutdown()
     {
+        // Release GPU resources while the context still exists
+        SceneLoader::Get().CancelAll();
+        ModelRegistry::Get().Clear();
+
+        // Closed early: report what was recorded so far
+        Tracer::Get().Stop(STARTUP_TRACE_FILE);
+        AssetDatabase::Get().Save();
+
         if (scene)
         {
             scene.reset();
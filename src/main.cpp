@@ -1,13 +1,60 @@
 #include <engine/engine.hpp>
 #include <engine/configure.hpp>
+#include <cstring>
+#include <cstdlib>
 
-int main()
+// Usage: engine [--headless] [--frames N] [--seconds S] [--width W] [--height H]
+//               [--scene file.oscn] [--save-scene file.oscn] [--scene-bench N]
+int main(int argc, char **argv)
 {
+    bool headless = false;
+    uint32_t frames = 0;
+    float seconds = 0.0f;
+    int width = SCREEN_WIDTH;
+    int height = SCREEN_HEIGHT;
+    const char *scenePath = nullptr;
+    const char *saveScenePath = nullptr;
+    uint32_t sceneBench = 0;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        bool hasValue = i + 1 < argc;
+        if (!std::strcmp(argv[i], "--headless"))
+            headless = true;
+        else if (!std::strcmp(argv[i], "--frames") && hasValue)
+            frames = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+        else if (!std::strcmp(argv[i], "--seconds") && hasValue)
+            seconds = std::strtof(argv[++i], nullptr);
+        else if (!std::strcmp(argv[i], "--width") && hasValue)
+            width = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--height") && hasValue)
+            height = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--scene") && hasValue)
+            scenePath = argv[++i];
+        else if (!std::strcmp(argv[i], "--save-scene") && hasValue)
+            saveScenePath = argv[++i];
+        else if (!std::strcmp(argv[i], "--scene-bench") && hasValue)
+            sceneBench = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+    }
+
+    // Never run a headless benchmark forever.
+    if (headless && frames == 0 && seconds <= 0.0f)
+        frames = 600;
+
     try
     {
         Engine::Engine engine;
-        engine.Initialize(SCREEN_WIDTH, SCREEN_HEIGHT, APPLICATION_TITLE);
-        engine.Run();
+        engine.Initialize(width, height, APPLICATION_TITLE, headless, scenePath);
+        if (sceneBench)
+            engine.BenchmarkSceneIO(sceneBench);
+        else if (headless)
+            engine.RunHeadless(frames, seconds);
+        else
+            engine.Run();
+
+        // After running, so models loaded in the background are part of it
+        if (saveScenePath)
+            engine.SaveScene(saveScenePath);
         engine.Shutdown();
     }
     catch (const std::exception &e)
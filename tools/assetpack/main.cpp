@@ -0,0 +1,74 @@
+// Packs asset directories into one .opak archive read by FileSystem.
+//
+//   assetpack <output.opak> <dir|file>... [--store]
+//
+// Entries are stored under the path given on the command line, so run it from
+// the directory the engine runs in: assetpack assets.opak assets
+#include <engine/assetpack.hpp>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        std::cout << "usage: assetpack <output.opak> <dir|file>... [--store]\n";
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    AssetPackWriter writer;
+    std::string output = argv[1];
+
+    std::vector<std::string> files;
+    for (int i = 2; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--store")
+        {
+            writer.compress = false;
+            continue;
+        }
+
+        std::error_code ec;
+        if (fs::is_regular_file(arg, ec))
+        {
+            files.push_back(arg);
+            continue;
+        }
+        if (!fs::is_directory(arg, ec))
+        {
+            std::cout << "Not found: " << arg << "\n";
+            return 1;
+        }
+
+        for (auto &item : fs::recursive_directory_iterator(arg, ec))
+            if (item.is_regular_file())
+                files.push_back(item.path().generic_string());
+    }
+
+    // Deterministic output for the same tree
+    std::sort(files.begin(), files.end());
+    for (auto &file : files)
+        writer.Add(file, file);
+
+    if (!writer.Write(output))
+    {
+        std::cout << "Failed to write " << output << "\n";
+        return 1;
+    }
+
+    const AssetPackWriter::Stats &stats = writer.GetStats();
+    float ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "Packed " << stats.files << " files (" << stats.compressed << " LZ4) into " << output << "\n";
+    std::cout << "  " << stats.rawBytes << " -> " << stats.storedBytes << " bytes in " << ms << " ms\n";
+    return 0;
+}